@@ -41,10 +41,14 @@ pc "$(oat framefilt mask --help)"
 off_ma="$pc_res"
 pc "$(oat framefilt mog --help)" 
 off_mo="$pc_res"
+pc "$(oat framefilt sigma --help)" 
+off_s="$pc_res"
 pc "$(oat framefilt undistort --help)" 
 off_u="$pc_res"
 pc "$(oat framefilt thresh --help)" 
 off_t="$pc_res"
+pc "$(oat framefilt resize --help)" 
+off_r="$pc_res"
 
 # oat-view type configurations
 pc "$(oat view frame --help)" 
@@ -100,8 +104,10 @@ awk -v ofs="$(oat frameserve --help)" \
     -v off_b="$off_b" \
     -v off_ma="$off_ma" \
     -v off_mo="$off_mo" \
+    -v off_s="$off_s" \
     -v off_u="$off_u" \
     -v off_t="$off_t" \
+    -v off_r="$off_r" \
     -v ovi="$(oat view --help)"      \
     -v ovi_f="$ovi_f" \
     -v opd="$(oat posidet --help)"   \
@@ -138,8 +144,10 @@ awk -v ofs="$(oat frameserve --help)" \
     sub(/oat-framefilt-bsub-help/, off_b);
     sub(/oat-framefilt-mask-help/, off_ma);
     sub(/oat-framefilt-mog-help/, off_mo);
+    sub(/oat-framefilt-sigma-help/, off_s);
     sub(/oat-framefilt-undistort-help/, off_u);
     sub(/oat-framefilt-thresh-help/, off_t);
+    sub(/oat-framefilt-resize-help/, off_r);
     sub(/oat-view-help/, ovi);
     sub(/oat-view-frame-help/, ovi_f);
     sub(/oat-posidet-help/, opd);
@@ -102,6 +102,16 @@ public:
         // Nothing
     }
 
+    // Shares m's data, and its reference count, rather than wrapping a raw
+    // buffer
+    Frame(cv::Mat m, const oat::PixelColor col, void *samp_ptr)
+    : cv::Mat(m)
+    , sample_ptr_(static_cast<Sample *>(samp_ptr))
+    , color_(col)
+    {
+        // Nothing
+    }
+
     Frame clone() const
     {
         Frame f(cv::Mat::clone());
@@ -127,8 +137,16 @@ public:
     void incrementSampleCount() { sample_ptr_->incrementCount(); }
     void incrementSampleCount(USec us) { sample_ptr_->incrementCount(us); }
 
+    // Latency stamps
+    void set_capture_ns(const uint64_t ns = Sample::monotonicNs())
+    {
+        sample_ptr_->set_capture_ns(ns);
+    }
+    void stampHop() { sample_ptr_->stampHop(); }
+
     // Provide copy of sample_
     oat::Sample sample() const { return *sample_ptr_; };
+    void set_sample(const oat::Sample &val) { *sample_ptr_ = val; }
 
     // Color accessors
     PixelColor color(void) const { return color_; }
@@ -31,7 +31,8 @@ const char Position2D::NPY_DTYPE[]{"[('tick', '<u8'),"
                                     "('head_ok', '<i1'),"
                                     "('head_xy', 'f8', (2)),"
                                     "('reg_ok', '<i1'),"
-                                    "('reg', 'a10')]"};
+                                    "('reg', 'a10'),"
+                                    "('lat_ns', '<u8')]"};
 
 // TODO: This feels horrible...
 std::vector<char> packPosition(const Position2D &p)
@@ -92,6 +93,12 @@ std::vector<char> packPosition(const Position2D &p)
     pack.insert(pack.end(), &rok, &rok + 1);
     pack.insert(pack.end(), p.region, p.region + oat::Position2D::REGION_LEN);
 
+    // Fields added after the initial format are appended so that readers of
+    // older files can index fields in the same positions
+    auto sl = p.latency_ns();
+    val = reinterpret_cast<char*>(&sl);
+    pack.insert(pack.end(), val, val + sizeof (sl));
+
     return pack;
 }
 
@@ -134,6 +134,21 @@ public:
     uint64_t sample_usec(void) const { return sample_.microseconds().count(); }
     void incrementSampleCount() { sample_.incrementCount(); }
     void incrementSampleCount(USec us) { sample_.incrementCount(us); }
+    const Sample &sample(void) const { return sample_; }
+
+    // Latency stamps
+    void set_capture_ns(const uint64_t ns = Sample::monotonicNs())
+    {
+        sample_.set_capture_ns(ns);
+    }
+    void stampHop() { sample_.stampHop(); }
+
+    // Time from capture to the last stamp, 0 if either is unknown
+    uint64_t latency_ns(void) const
+    {
+        const size_t n = sample_.num_hops();
+        return n > 0 ? sample_.latency_ns(sample_.hop_ns(n - 1)) : 0;
+    }
 
     void setCoordSystem(const DistanceUnit value, const cv::Matx33d homography)
     {
@@ -141,7 +156,7 @@ public:
         homography_ = homography;
     }
 
-    static constexpr size_t NPY_DTYPE_BYTES {82};
+    static constexpr size_t NPY_DTYPE_BYTES {90};
     static const char NPY_DTYPE[];
 
 private:
@@ -180,10 +195,41 @@ void serializePosition(const Position2D &p, Writer &writer, bool verbose)
     writer.String("usec");
     writer.Uint64(p.sample_usec());
 
+    // Latency from capture to the last stage that stamped this sample, and
+    // to each of the stages before it
+    const auto &s = p.sample_;
+    writer.String("lat_ns");
+    writer.Uint64(p.latency_ns());
+
+    if (s.num_hops() > 0 || verbose) {
+        writer.String("hop_ns");
+        writer.StartArray();
+        for (size_t i = 0; i < s.num_hops(); i++)
+            writer.Uint64(s.latency_ns(s.hop_ns(i)));
+        writer.EndArray(s.num_hops());
+    }
+
     // Coordinate system
     writer.String("unit");
     writer.Int(static_cast<int>(p.unit_of_length_));
 
+    // Mapping from pixel positions to full resolution frames, if frames were
+    // cropped or downsampled before detection
+    const bool pixels = p.unit_of_length_ == DistanceUnit::PIXELS;
+    if ((pixels && !s.full_resolution()) || verbose) {
+        writer.String("px_off");
+        writer.StartArray();
+        writer.Double(s.pixel_offset().x);
+        writer.Double(s.pixel_offset().y);
+        writer.EndArray(2);
+
+        writer.String("px_scale");
+        writer.StartArray();
+        writer.Double(s.pixel_scale().x);
+        writer.Double(s.pixel_scale().y);
+        writer.EndArray(2);
+    }
+
     // Position
     writer.String("pos_ok");
     writer.Bool(p.position_valid || verbose);
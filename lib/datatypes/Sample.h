@@ -23,7 +23,9 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <ratio>
+#include <time.h>
 
 #include <opencv2/core/mat.hpp>
 
@@ -31,6 +33,15 @@ namespace oat {
 
 /**
  * Class specifying general sample timing information.
+ *
+ * Besides the sample clock, a sample carries the CLOCK_MONOTONIC time at
+ * which it was captured and a stamp from each stage that processed it since.
+ * These are comparable between processes on the same host, so the consumer
+ * at the end of a pipeline can compute per-sample latency.
+ *
+ * A sample also records how the pixels of a frame map onto the frame that
+ * was originally captured, so that positions detected in cropped or
+ * downsampled frames can be mapped back to full resolution.
  */
 class Sample {
 
@@ -40,6 +51,20 @@ public:
     using Microseconds = std::chrono::microseconds; 
     using IEEE1394Tick = std::chrono::duration<float, std::ratio<1,8000>>;
 
+    // Number of processing stages that can stamp a sample
+    static constexpr size_t MAX_HOPS {8};
+
+    /**
+     * @brief Current CLOCK_MONOTONIC time.
+     * @return Time in nanoseconds
+     */
+    static uint64_t monotonicNs()
+    {
+        struct timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return static_cast<uint64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+    }
+
     explicit Sample()
     {
         // Nothing
@@ -107,6 +132,97 @@ public:
             std::chrono::duration_cast<Microseconds>(period_sec_);
     }
 
+    /**
+     * @brief Set the time at which the sample was captured and clear any
+     * stamps left by the stages that processed the previous one. Only pure
+     * SINKs should set the capture time.
+     *
+     * @param ns CLOCK_MONOTONIC capture time in nanoseconds.
+     */
+    void set_capture_ns(const uint64_t ns = monotonicNs()) {
+        capture_ns_ = ns;
+        num_hops_ = 0;
+    }
+
+    /**
+     * @brief Record that a processing stage has finished with this sample.
+     * Stamps beyond MAX_HOPS are dropped.
+     *
+     * @return False if the stamp was dropped.
+     */
+    bool stampHop(const uint64_t ns = monotonicNs()) {
+        if (num_hops_ >= MAX_HOPS)
+            return false;
+
+        hop_ns_[num_hops_++] = ns;
+        return true;
+    }
+
+    /**
+     * @brief Time since capture.
+     *
+     * @param ns CLOCK_MONOTONIC time to measure up to in nanoseconds.
+     * @return Latency in nanoseconds, or 0 if the capture time is unknown.
+     */
+    uint64_t latency_ns(const uint64_t ns = monotonicNs()) const {
+        return capture_ns_ == 0 || ns < capture_ns_ ? 0 : ns - capture_ns_;
+    }
+
+    /**
+     * @brief Move the capture time and stamps to another clock, e.g. that of
+     * a different host.
+     *
+     * @param from_ns A time on the current clock.
+     * @param to_ns The same time on the new clock.
+     */
+    void rebase(const uint64_t from_ns, const uint64_t to_ns) {
+        if (capture_ns_ == 0)
+            return;
+
+        capture_ns_ += to_ns - from_ns;
+        for (uint32_t i = 0; i < num_hops_; i++)
+            hop_ns_[i] += to_ns - from_ns;
+    }
+
+    /**
+     * @brief Record that a frame was cropped and/or resampled. Pixel q of the
+     * new frame is at offset + scale * q in the frame it was made from. This
+     * is composed with any earlier cropping or resampling.
+     *
+     * @param offset Position of pixel (0, 0) of the new frame, in pixels of
+     * the frame it was made from.
+     * @param scale Size of a pixel of the new frame, in pixels of the frame
+     * it was made from.
+     */
+    void resample(const cv::Point2d &offset, const cv::Point2d &scale) {
+        offset_x_ += scale_x_ * offset.x;
+        offset_y_ += scale_y_ * offset.y;
+        scale_x_ *= scale.x;
+        scale_y_ *= scale.y;
+    }
+
+    /**
+     * @brief Map a pixel position to the full resolution frame.
+     *
+     * @param p Position in pixels of the current frame.
+     * @return Position in pixels of the frame that was captured.
+     */
+    cv::Point2d toFullResolution(const cv::Point2d &p) const {
+        return cv::Point2d(offset_x_ + scale_x_ * p.x,
+                           offset_y_ + scale_y_ * p.y);
+    }
+
+    cv::Point2d pixel_offset() const { return cv::Point2d(offset_x_, offset_y_); }
+    cv::Point2d pixel_scale() const { return cv::Point2d(scale_x_, scale_y_); }
+    bool full_resolution() const {
+        return offset_x_ == 0 && offset_y_ == 0
+               && scale_x_ == 1 && scale_y_ == 1;
+    }
+
+    uint64_t capture_ns() const { return capture_ns_; }
+    size_t num_hops() const { return num_hops_; }
+    uint64_t hop_ns(const size_t i) const { return hop_ns_[i]; }
+
     uint64_t count() const { return count_; }
     Microseconds microseconds() const { return microseconds_; }
     Seconds period_sec() const { return period_sec_; }
@@ -120,6 +236,19 @@ private:
     Seconds period_sec_ {0.0};
     Microseconds period_microseconds_ {0};
     double rate_hz_ {0.0};
+
+    // Latency stamps
+    uint64_t capture_ns_ {0};
+    uint64_t hop_ns_[MAX_HOPS] {0};
+    uint32_t num_hops_ {0};
+
+    // Mapping from frame pixels to full resolution pixels. Plain doubles
+    // rather than cv::Point2d, which is not trivially copyable in OpenCV 3,
+    // so that samples can be copied as raw bytes.
+    double offset_x_ {0};
+    double offset_y_ {0};
+    double scale_x_ {1};
+    double scale_y_ {1};
 };
 
 }      /* namespace oat */
@@ -0,0 +1,295 @@
+//******************************************************************************
+//* File:   Arena.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_ARENA_H
+#define	OAT_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <boost/interprocess/offset_ptr.hpp>
+
+namespace oat {
+
+namespace bip = boost::interprocess;
+
+/**
+ * @brief Bump allocator over a fixed block of memory, normally a block in a
+ * node's shared object segment. Allocating is a pointer increment and
+ * allocations are never freed individually; the whole arena is cleared at
+ * once instead. Pointers are stored as offsets so that the arena and
+ * everything allocated from it can be mapped at different addresses by
+ * different processes.
+ */
+class ArenaAllocator {
+public:
+
+    // Storage must be aligned to at least this
+    static constexpr size_t ALIGNMENT {16};
+
+    ArenaAllocator() = default;
+
+    ArenaAllocator(void *storage, const size_t capacity)
+    : storage_(static_cast<char *>(storage))
+    , capacity_(capacity)
+    {
+        // Nothing
+    }
+
+    // Allocations refer back to their arena, so it cannot be copied
+    ArenaAllocator(const ArenaAllocator &) = delete;
+    ArenaAllocator & operator=(const ArenaAllocator &) = delete;
+
+    /**
+     * @brief Allocate uninitialized memory.
+     * @param bytes Number of bytes
+     * @param align Alignment. Must be a power of two no greater than
+     * ALIGNMENT.
+     * @return Pointer to the allocation. Throws if the arena is exhausted.
+     */
+    void *allocate(const size_t bytes, const size_t align)
+    {
+        if (align > ALIGNMENT)
+            throw std::runtime_error("Arena allocations cannot be aligned to "
+                                     "more than "
+                                     + std::to_string(ALIGNMENT) + " bytes.");
+
+        const size_t offset = (used_ + align - 1) & ~(align - 1);
+        if (offset + bytes > capacity_)
+            throw std::runtime_error("Arena exhausted: "
+                                     + std::to_string(offset + bytes)
+                                     + " bytes required, "
+                                     + std::to_string(capacity_)
+                                     + " available.");
+
+        used_ = offset + bytes;
+        return storage_.get() + offset;
+    }
+
+    template <typename E>
+    E *allocate(const size_t n)
+    {
+        return static_cast<E *>(allocate(n * sizeof(E), alignof(E)));
+    }
+
+    // Invalidate all allocations
+    void clear(void) { used_ = 0; }
+
+    size_t capacity(void) const { return capacity_; }
+    size_t used(void) const { return used_; }
+    size_t available(void) const { return capacity_ - used_; }
+
+protected:
+
+    void set_storage(void *storage, const size_t capacity)
+    {
+        storage_ = static_cast<char *>(storage);
+        capacity_ = capacity;
+        used_ = 0;
+    }
+
+private:
+
+    bip::offset_ptr<char> storage_;
+    size_t capacity_ {0};
+    size_t used_ {0};
+};
+
+namespace detail {
+
+// Construct an E at p. Types that allocate from an arena (i.e. that are
+// constructible from an ArenaAllocator &) are given the arena.
+template <typename E, typename ...Args>
+E *arenaConstruct(std::true_type, void *p, ArenaAllocator &a, Args&&... args)
+{
+    return new (p) E(a, std::forward<Args>(args)...);
+}
+
+template <typename E, typename ...Args>
+E *arenaConstruct(std::false_type, void *p, ArenaAllocator &, Args&&... args)
+{
+    return new (p) E(std::forward<Args>(args)...);
+}
+
+template <typename E, typename ...Args>
+E *arenaConstruct(void *p, ArenaAllocator &a, Args&&... args)
+{
+    return arenaConstruct<E>(
+        std::integral_constant<bool,
+            std::is_constructible<E, ArenaAllocator &, Args...>::value>(),
+        p, a, std::forward<Args>(args)...);
+}
+
+} // namespace detail
+
+/**
+ * @brief Vector whose elements are allocated from an arena. Growing the
+ * vector allocates a new block and leaves the old one unused until the arena
+ * is cleared, so reserve() should be used when the final size is known.
+ * Elements are never destroyed and so must be trivially destructible.
+ * ArenaVectors can be nested, in which case the inner vectors allocate from
+ * the same arena.
+ */
+template <typename E>
+class ArenaVector {
+
+    static_assert(std::is_trivially_destructible<E>::value,
+                  "ArenaVector elements must be trivially destructible.");
+
+public:
+
+    using value_type = E;
+    using iterator = E *;
+    using const_iterator = const E *;
+
+    explicit ArenaVector(ArenaAllocator &arena)
+    : arena_(&arena)
+    {
+        // Nothing
+    }
+
+    size_t size(void) const { return size_; }
+    size_t capacity(void) const { return capacity_; }
+    bool empty(void) const { return size_ == 0; }
+
+    E *data(void) { return data_.get(); }
+    const E *data(void) const { return data_.get(); }
+
+    iterator begin(void) { return data(); }
+    iterator end(void) { return data() + size_; }
+    const_iterator begin(void) const { return data(); }
+    const_iterator end(void) const { return data() + size_; }
+
+    E &operator[](const size_t i) { return data_[i]; }
+    const E &operator[](const size_t i) const { return data_[i]; }
+
+    E &back(void) { return data_[size_ - 1]; }
+    const E &back(void) const { return data_[size_ - 1]; }
+
+    void reserve(const size_t n)
+    {
+        if (n <= capacity_)
+            return;
+
+        E *fresh = arena_->allocate<E>(n);
+        for (size_t i = 0; i < size_; i++)
+            new (fresh + i) E(std::move(data_[i]));
+
+        data_ = fresh;
+        capacity_ = n;
+    }
+
+    template <typename ...Args>
+    E &emplace_back(Args&&... args)
+    {
+        if (size_ == capacity_)
+            reserve(capacity_ == 0 ? MIN_CAPACITY : 2 * capacity_);
+
+        E *e = detail::arenaConstruct<E>(
+                data_.get() + size_, *arena_, std::forward<Args>(args)...);
+        size_++;
+
+        return *e;
+    }
+
+    void push_back(const E &e) { emplace_back(e); }
+
+    // Replace contents with a copy of [first, last)
+    template <typename It>
+    void assign(It first, It last)
+    {
+        clear();
+        reserve(static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    void clear(void) { size_ = 0; }
+
+    ArenaAllocator &arena(void) const { return *arena_; }
+
+private:
+
+    static constexpr size_t MIN_CAPACITY {8};
+
+    bip::offset_ptr<ArenaAllocator> arena_;
+    bip::offset_ptr<E> data_;
+    size_t size_ {0};
+    size_t capacity_ {0};
+};
+
+template <typename E>
+constexpr size_t ArenaVector<E>::MIN_CAPACITY;
+
+/**
+ * @brief Variable size token. A root object of type T together with an arena
+ * that the root, e.g. an ArenaVector or a struct of them, allocates from.
+ * When used as the type of a node (i.e. Sink<Arena<T>>), each ring slot has
+ * its own arena, and it is reset before each write so that nothing has to
+ * be freed and no heap allocation takes place.
+ */
+template <typename T>
+class Arena : public ArenaAllocator {
+
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena roots must be trivially destructible.");
+
+public:
+
+    Arena()
+    {
+        reset();
+    }
+
+    T &value(void) { return *reinterpret_cast<T *>(&root_); }
+    const T &value(void) const { return *reinterpret_cast<const T *>(&root_); }
+
+    /**
+     * @brief Invalidate all allocations and construct a fresh root.
+     */
+    void reset(void)
+    {
+        clear();
+        detail::arenaConstruct<T>(&root_, *this);
+    }
+
+    /**
+     * @brief Give the arena its storage.
+     * @param storage Block of at least capacity bytes aligned to ALIGNMENT.
+     * @param capacity Size of block in bytes.
+     */
+    void set_storage(void *storage, const size_t capacity)
+    {
+        ArenaAllocator::set_storage(storage, capacity);
+        reset();
+    }
+
+private:
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type root_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_ARENA_H */
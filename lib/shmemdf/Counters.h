@@ -0,0 +1,122 @@
+//******************************************************************************
+//* File:   Counters.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_COUNTERS_H
+#define	OAT_COUNTERS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace oat {
+
+/**
+ * @brief Performance counters for one end (the SINK or a single SOURCE) of a
+ * node. They live in the node's shared memory segment.
+ *
+ * Each set of counters is only written by the component that owns that end
+ * of the node, so updates are relaxed loads and stores rather than
+ * read-modify-write operations. Monitors such as oat-top map the node
+ * read-only and never write to them, so reading does not perturb the
+ * pipeline. A monitor may see counters that were updated at slightly
+ * different times.
+ */
+struct alignas(64) Counters {
+
+    using clock = std::chrono::steady_clock;
+
+    // Monotonic time that is comparable between processes
+    static uint64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Clear all counters. Used when a new component takes over this end
+     * of the node.
+     * @param owner PID of the owning process
+     */
+    void reset(const int32_t owner = 0)
+    {
+        for (auto c : {&waits, &wait_ns, &max_wait_ns, &posts,
+                       &last_post_ns, &post_interval_ns, &max_post_interval_ns})
+            c->store(0, std::memory_order_relaxed);
+
+        pid.store(owner, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Account for a completed wait() on the node.
+     * @param start Time at which the wait started
+     */
+    void recordWait(const uint64_t start)
+    {
+        const uint64_t ns = now() - start;
+
+        increment(waits, 1);
+        increment(wait_ns, ns);
+        if (ns > max_wait_ns.load(std::memory_order_relaxed))
+            max_wait_ns.store(ns, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Account for a post() to the node, i.e. a completed write or read.
+     */
+    void recordPost(void)
+    {
+        const uint64_t t = now();
+        const uint64_t last = last_post_ns.load(std::memory_order_relaxed);
+
+        if (last != 0) {
+            const uint64_t ns = t - last;
+            increment(post_interval_ns, ns);
+            if (ns > max_post_interval_ns.load(std::memory_order_relaxed))
+                max_post_interval_ns.store(ns, std::memory_order_relaxed);
+        }
+
+        last_post_ns.store(t, std::memory_order_relaxed);
+        increment(posts, 1);
+    }
+
+    std::atomic<int32_t> pid {0}; //!< Owning process
+
+    // Time blocked in wait()
+    std::atomic<uint64_t> waits {0};
+    std::atomic<uint64_t> wait_ns {0}; //!< Cumulative
+    std::atomic<uint64_t> max_wait_ns {0};
+
+    // Completed writes (SINK) or reads (SOURCE), and the time between them
+    std::atomic<uint64_t> posts {0};
+    std::atomic<uint64_t> last_post_ns {0};
+    std::atomic<uint64_t> post_interval_ns {0}; //!< Cumulative
+    std::atomic<uint64_t> max_post_interval_ns {0};
+
+private:
+
+    // Single writer, so no need for an atomic read-modify-write
+    static void increment(std::atomic<uint64_t> &c, const uint64_t n)
+    {
+        c.store(c.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+    }
+};
+
+}       /* namespace oat */
+#endif	/* OAT_COUNTERS_H */
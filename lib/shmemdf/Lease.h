@@ -0,0 +1,102 @@
+//******************************************************************************
+//* File:   Lease.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_LEASE_H
+#define	OAT_LEASE_H
+
+#include <type_traits>
+#include <utility>
+
+namespace oat {
+
+/**
+ * @brief Scoped, in-place access to the shared object occupying a node's
+ * current ring slot. A lease is obtained by waiting on a SINK or SOURCE and
+ * is released, by posting to it, either explicitly or when the lease is
+ * destroyed. The object is valid and will not be overwritten by the node's
+ * SINK (or read by its SOURCES) until the lease is released. Nothing is
+ * copied.
+ *
+ * A const qualified T gives read-only access. A default constructed lease is
+ * empty. SOURCES return an empty lease when
+ * the SINK has reached the END state.
+ */
+template <typename Endpoint, typename T>
+class Lease {
+public:
+
+    Lease() = default;
+
+    Lease(Endpoint *endpoint, const T &object)
+    : endpoint_(endpoint)
+    , object_(object)
+    {
+        // Nothing
+    }
+
+    // Leases are move only
+    Lease(const Lease &) = delete;
+    Lease & operator=(const Lease &) = delete;
+
+    Lease(Lease &&other)
+    : endpoint_(other.endpoint_)
+    , object_(std::move(other.object_))
+    {
+        other.endpoint_ = nullptr;
+    }
+
+    Lease & operator=(Lease &&other)
+    {
+        if (this != &other) {
+            release();
+            endpoint_ = other.endpoint_;
+            object_ = std::move(other.object_);
+            other.endpoint_ = nullptr;
+        }
+
+        return *this;
+    }
+
+    ~Lease() { release(); }
+
+    /**
+     * @brief Give the shared object back to the node. The object must not be
+     * used after this call.
+     */
+    void release()
+    {
+        if (endpoint_ != nullptr) {
+            endpoint_->post();
+            endpoint_ = nullptr;
+        }
+    }
+
+    explicit operator bool() const { return endpoint_ != nullptr; }
+
+    T & operator*() { return object_; }
+    T * operator->() { return &object_; }
+
+private:
+
+    Endpoint *endpoint_ {nullptr};
+    typename std::remove_const<T>::type object_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_LEASE_H */
@@ -0,0 +1,233 @@
+//******************************************************************************
+//* File:   LocalNode.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_LOCALNODE_H
+#define	OAT_LOCALNODE_H
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+#include "../datatypes/Color.h"
+#include "../datatypes/Sample.h"
+
+#include "Node.h"
+
+namespace oat {
+
+/**
+ * @brief Frames exchanged through a LocalNode: one reference counted matrix
+ * and sample per ring slot. The SINK and its SOURCES wrap the same matrices,
+ * so nothing is copied, and the pixels stay valid for as long as any of them
+ * still holds a frame.
+ */
+struct LocalFrames {
+    std::vector<cv::Mat> data;
+    std::vector<oat::Sample> samples;
+    oat::PixelColor color {oat::PIX_BGR};
+};
+
+/**
+ * @brief Heap backed node for a SINK and SOURCES that are threads of the
+ * same process, e.g. adjacent stages hosted by oat-run.
+ *
+ * An address is made local by reserving it before any SINK or SOURCE opens
+ * it. From then on, SINKS and SOURCES in this process use the node and
+ * shared objects held here rather than /dev/shm segments. The ring slot
+ * protocol is unchanged. Local nodes are not visible to other processes or
+ * to oat-top.
+ */
+class LocalNode {
+public:
+
+    LocalNode() = default;
+
+    ~LocalNode()
+    {
+        if (node_ != nullptr) {
+            for (size_t i = 0; i < node_->num_slots(); i++)
+                slots_[i].~Slot();
+            node_->~Node();
+            std::free(node_);
+        }
+    }
+
+    // Local nodes are shared by reference, never copied
+    LocalNode(const LocalNode &) = delete;
+    LocalNode & operator=(const LocalNode &) = delete;
+
+    /**
+     * @brief Make the node at an address local to this process. Must be
+     * called before any SINK or SOURCE opens the address. A node left at the
+     * address by SINKS and SOURCES that have all been destroyed is replaced
+     * by a new one.
+     * @param address Node address
+     */
+    static void reserve(const std::string &address)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto &node = registry()[address];
+        if (!node || node.use_count() == 1)
+            node = std::make_shared<LocalNode>();
+    }
+
+    /**
+     * @brief Find the local node reserved at an address.
+     * @param address Node address
+     * @return The node, or nullptr if the address was not reserved and must
+     * be opened in shared memory.
+     */
+    static std::shared_ptr<LocalNode> find(const std::string &address)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto it = registry().find(address);
+        return it == registry().end() ? nullptr : it->second;
+    }
+
+    /**
+     * @brief End every local node, waking all of their SINKS and SOURCES,
+     * and tell SINKS and SOURCES waiting on shared memory nodes in this
+     * process to give up the next time they wake to check on their peers.
+     */
+    static void cancelAll(void)
+    {
+        cancelFlag().store(true);
+
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (auto &r : registry()) {
+            std::lock_guard<std::mutex> node_lock(r.second->mutex_);
+            if (r.second->node_ != nullptr)
+                r.second->node_->set_sink_state(NodeState::END);
+        }
+    }
+
+    /**
+     * @brief Check if cancelAll() was called.
+     */
+    static bool cancelled(void)
+    {
+        return cancelFlag().load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the node, creating it along with its SOURCE slots if it
+     * does not exist yet.
+     * @param num_slots Number of SOURCE slots if the node is created
+     */
+    Node &node(const size_t num_slots)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (node_ == nullptr) {
+
+            // Same cache aligned layout as Node::findOrConstruct
+            void *mem {nullptr};
+            if (posix_memalign(&mem, CACHE_LINE_SIZE,
+                               sizeof(Node) + num_slots * sizeof(Node::Slot)))
+                throw std::bad_alloc();
+
+            slots_ = reinterpret_cast<Node::Slot *>(static_cast<char *>(mem)
+                                                    + sizeof(Node));
+            for (size_t i = 0; i < num_slots; i++)
+                new (slots_ + i) Node::Slot();
+
+            node_ = new (mem) Node(slots_, num_slots);
+
+            // A runner that was cancelled before this node was opened
+            if (cancelled())
+                node_->set_sink_state(NodeState::END);
+        }
+
+        return *node_;
+    }
+
+    /**
+     * @brief Construct the shared objects of the node, replacing any that
+     * were constructed before.
+     * @param count Number of objects
+     * @param args Constructor arguments of each object
+     * @return Pointer to the first object
+     */
+    template <typename T, typename ...Targs>
+    T *construct(const size_t count, Targs... args)
+    {
+        auto objects = std::make_shared<std::vector<T>>();
+        objects->reserve(count);
+        for (size_t i = 0; i < count; i++)
+            objects->emplace_back(args...);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        objects_ = objects;
+        type_ = typeid(T).name();
+
+        return objects->data();
+    }
+
+    /**
+     * @brief Find the shared objects constructed by the SINK.
+     * @return Pointer to the first object, or nullptr if there are none or
+     * they are not of type T.
+     */
+    template <typename T>
+    T *find(void) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!objects_ || type_ != typeid(T).name())
+            return nullptr;
+
+        return static_cast<std::vector<T> *>(objects_.get())->data();
+    }
+
+private:
+
+    static std::map<std::string, std::shared_ptr<LocalNode>> &registry(void)
+    {
+        static std::map<std::string, std::shared_ptr<LocalNode>> r;
+        return r;
+    }
+
+    static std::mutex &registryMutex(void)
+    {
+        static std::mutex m;
+        return m;
+    }
+
+    static std::atomic<bool> &cancelFlag(void)
+    {
+        static std::atomic<bool> c {false};
+        return c;
+    }
+
+    mutable std::mutex mutex_;
+    Node *node_ {nullptr};
+    Node::Slot *slots_ {nullptr};
+    std::shared_ptr<void> objects_;
+    std::string type_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_LOCALNODE_H */
@@ -17,17 +17,29 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+
 #ifndef OAT_NODE_H
 #define	OAT_NODE_H
 
 #include <iostream>
 #include <array>
 #include <atomic>
-#include <bitset>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
 #include <string>
-#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+#include <typeinfo>
+#include <utility>
+
+#include <signal.h>
 
+#include <boost/interprocess/offset_ptr.hpp>
+
+#include "Counters.h"
 #include "ForwardsDecl.h"
+#include "Semaphore.h"
 
 namespace oat {
 
@@ -35,152 +47,663 @@ enum class NodeState {
     END = -1,
     UNDEFINED = 0,
     SINK_BOUND = 1,
-    ERROR = 2
+    ERROR = 2,
+    DETACHED = 3 //!< SINK left, but a new one may resume the stream
+};
+
+// Members written by different processes are kept on separate cache lines to
+// prevent false sharing
+static constexpr size_t CACHE_LINE_SIZE {64};
+
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) CacheAligned {
+
+    template <typename ...Targs>
+    explicit CacheAligned(Targs&&... args)
+    : value(std::forward<Targs>(args)...)
+    {
+        // Nothing
+    }
+
+    T value;
 };
 
 class Node {
 public:
 
-    using semaphore = bip::interprocess_semaphore;
+    using semaphore = oat::Semaphore;
+    using mask_t = uint64_t;
+
+    // Components blocked on the node wake up this often to check that their
+    // peers are still alive
+    static constexpr uint64_t HEARTBEAT_NS {100000000};
+
+    /**
+     * @brief Process that owns one end (the SINK or a single SOURCE) of the
+     * node.
+     */
+    struct alignas(CACHE_LINE_SIZE) Owner {
+
+        void claim(const int32_t owner) { pid.store(owner); }
+
+        /**
+         * @brief Check if the owning process has exited without releasing
+         * its end of the node, e.g. because it crashed or was killed.
+         */
+        bool dead(void) const
+        {
+            const int32_t p = pid.load();
+            if (p <= 0 || ::kill(p, 0) == 0)
+                return false;
+
+            // EPERM means that the process exists but belongs to another
+            // user. It is taken to be alive: a component can legitimately
+            // spend a long time between calls to the node, so there is
+            // nothing else to judge it by.
+            return errno == ESRCH;
+        }
 
-    Node()
+        std::atomic<int32_t> pid {0}; //!< 0 if unowned
+    };
+
+    // SOURCE slots. The number of slots is fixed when the node is created.
+    static constexpr size_t DEFAULT_SLOTS {64};
+    static constexpr size_t MAX_SLOTS {512};
+
+    /**
+     * @brief Per-SOURCE synchronization state. These are stored in an array,
+     * sized when the node is created, that lives next to the node in shared
+     * memory.
+     */
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        semaphore read_barrier {0};
+        std::atomic<uint64_t> read_number {0}; //!< Next write number to be read by this SOURCE
+        Counters counters; //!< Performance counters of this SOURCE
+        Owner owner; //!< Process holding this slot
+    };
+
+    /**
+     * @brief Construct a node that manages the given SOURCE slots.
+     * @param slots Array of num_slots SOURCE slots. Must outlive the node.
+     * @param num_slots Number of SOURCE slots
+     */
+    Node(Slot *slots, const size_t num_slots)
+    : slots_(slots)
+    , num_slots_(num_slots)
+    , num_words_((num_slots + MASK_BITS - 1) / MASK_BITS)
     {
-        source_slots_.reset();
-        source_read_required_.reset();
-    }
+        if (num_slots < 1 || num_slots > MAX_SLOTS)
+            throw std::runtime_error("Number of node slots must be between 1 "
+                                     "and " + std::to_string(MAX_SLOTS) + ".");
+
+        for (auto &r : source_read_required_) {
+            r.words_left = 0;
+            for (auto &w : r.words)
+                w = 0;
+        }
 
-    // Nodes are movable
-    Node(Node&&) = default;
-    Node & operator=(Node&&) = default;
+        for (auto m : {&allocated_, &joining_, &leaving_, &active_}) {
+            for (auto &w : m->value)
+                w = 0;
+        }
+    }
 
     // Nodes are not copyable
     Node(const Node &) = delete;
     Node & operator=(const Node &) = delete;
 
+    /**
+     * @brief Find the node in a node shared memory segment, or create it
+     * along with its SOURCE slots if it does not exist yet.
+     * @param shmem Node shared memory segment
+     * @param num_slots Number of SOURCE slots if the node is created
+     * @return Pointer to the node
+     */
+    static Node *findOrConstruct(shmem_t &shmem, const size_t num_slots)
+    {
+        using node_ptr_t = bip::offset_ptr<Node>;
+
+        // Named construction only guarantees 16 byte alignment, so the node
+        // and its slots are placed in a cache aligned block that is found
+        // through a named pointer
+        Node *node {nullptr};
+        auto find_or_construct = [&shmem, &node, num_slots] {
+
+            node_ptr_t *ptr = shmem.find<node_ptr_t>(typeid(Node).name()).first;
+            if (ptr != nullptr) {
+                node = ptr->get();
+                return;
+            }
+
+            void *mem = shmem.allocate_aligned(
+                    sizeof(Node) + num_slots * sizeof(Slot), CACHE_LINE_SIZE);
+            Slot *slots = reinterpret_cast<Slot *>(static_cast<char *>(mem)
+                                                   + sizeof(Node));
+            for (size_t i = 0; i < num_slots; i++)
+                new (slots + i) Slot();
+
+            node = new (mem) Node(slots, num_slots);
+            shmem.construct<node_ptr_t>(typeid(Node).name())(node);
+        };
+        shmem.atomic_func(find_or_construct);
+
+        return node;
+    }
+
+    /**
+     * @brief Unlink the node and object segments at the given addresses if
+     * the node they currently hold satisfies a predicate. Processes that
+     * still map the segments are unaffected.
+     * @param node_address Name of the node shared memory segment
+     * @param obj_address Name of the object shared memory segment
+     * @param pred Predicate taking a const Node &
+     * @return True if the segments were unlinked
+     */
+    template <typename Pred>
+    static bool unlinkIf(const std::string &node_address,
+                         const std::string &obj_address,
+                         Pred pred)
+    {
+        using node_ptr_t = bip::offset_ptr<Node>;
+
+        try {
+            // A process may have died holding the segment's mutex, so look
+            // without taking it
+            shmem_t shmem(bip::open_read_only, node_address.c_str());
+            auto ptr = shmem.find_no_lock<node_ptr_t>(typeid(Node).name()).first;
+            if (ptr == nullptr || !pred(*ptr->get()))
+                return false;
+        } catch (const bip::interprocess_exception &) {
+            return false;
+        }
+
+        bip::shared_memory_object::remove(node_address.c_str());
+        bip::shared_memory_object::remove(obj_address.c_str());
+
+        return true;
+    }
+
+    /**
+     * @brief Unlink the segments at the given addresses if the SINK that
+     * bound them has died and did not ask to be resumed. SOURCES still
+     * attached to them will find the SINK gone and end.
+     */
+    static bool unlinkIfAbandoned(const std::string &node_address,
+                                  const std::string &obj_address)
+    {
+        return unlinkIf(node_address, obj_address, [](const Node &n) {
+            return n.sink_died() && !n.reconnectable();
+        });
+    }
+
+    /**
+     * @brief Whether SINKS and SOURCES are reconnectable unless told
+     * otherwise: true if OAT_RECONNECT is set in the environment.
+     */
+    static bool reconnectByDefault(void)
+    {
+        const char *env = std::getenv("OAT_RECONNECT");
+        return env != nullptr && *env != '\0' && *env != '0';
+    }
+
+    /**
+     * @brief Unlink the segments at the given addresses if they still hold
+     * this node rather than one that replaced it.
+     */
+    bool unlink(const std::string &node_address,
+                const std::string &obj_address) const
+    {
+        const uint64_t id = id_;
+        return unlinkIf(node_address, obj_address,
+                        [id](const Node &n) { return n.id_ == id; });
+    }
+
+    /**
+     * @brief Size of a node shared memory segment that can hold a node with
+     * the given number of SOURCE slots.
+     * @param num_slots Number of SOURCE slots
+     * @return Segment size in bytes
+     */
+    static size_t segmentSize(const size_t num_slots)
+    {
+        // Extra 1024 bytes are used to hold managed shared mem helper objects
+        // (name-object index, internal synchronization objects, internal
+        // variables...). One more slot's worth covers alignment padding.
+        return 1024 + sizeof(Node) + (num_slots + 1) * sizeof(Slot);
+    }
+
+    size_t num_slots(void) const { return num_slots_; }
+
     // SINK state
-    void set_sink_state(NodeState value) { sink_state_ = value; }
+    void set_sink_state(NodeState value)
+    {
+        sink_state_ = value;
+
+        // Broadcast END to all waiters rather than making them poll for it
+        if (value == NodeState::END)
+            closeBarriers();
+    }
+
     NodeState sink_state(void) const { return sink_state_; }
 
+    /**
+     * @brief Check if a SINK bound the node and then died without unbinding.
+     */
+    bool sink_died(void) const
+    {
+        return sink_state_ != NodeState::UNDEFINED && sink_owner_.dead();
+    }
+
+    /**
+     * @brief Check if the SINK has left, cleanly or not, without ending the
+     * stream, so that a new SINK may resume it.
+     */
+    bool sink_gone(void) const
+    {
+        const NodeState s = sink_state_;
+        return s == NodeState::DETACHED
+               || (s == NodeState::SINK_BOUND && sink_owner_.dead());
+    }
+
+    // Set by the SINK when it binds: true if the stream should survive its
+    // departure
+    bool reconnectable(void) const { return reconnectable_; }
+    void set_reconnectable(const bool value) { reconnectable_ = value; }
+
+    /**
+     * @brief Leave the node without ending the stream. SOURCES keep waiting
+     * until a new SINK resumes it.
+     */
+    void detachSink(void)
+    {
+        sink_owner_.pid.store(0);
+        sink_state_ = NodeState::DETACHED;
+    }
+
+    // Set by the SINK between wait() and post(). A SINK that leaves while
+    // holding a free ring slot must return it so that the next SINK can
+    // use it.
+    bool sink_writing(void) const
+    {
+        return sink_writing_.load(std::memory_order_relaxed);
+    }
+
+    void set_sink_writing(const bool value)
+    {
+        sink_writing_.store(value, std::memory_order_relaxed);
+    }
+
+    // Ring depth: the number of samples the SINK may write ahead of its
+    // slowest SOURCE
+    static constexpr size_t MAX_DEPTH {64};
+
+    size_t depth(void) const { return depth_; }
+
+    /**
+     * @brief Set the number of object slots in the node's ring. Must only be
+     * called by the SINK when it binds the node, before its first write.
+     * @param depth Ring depth
+     */
+    void set_depth(const size_t depth)
+    {
+        if (depth < 1 || depth > MAX_DEPTH)
+            throw std::runtime_error("Node depth must be between 1 and "
+                                     + std::to_string(MAX_DEPTH) + ".");
+
+        // The write barrier counts free slots. It was constructed with one.
+        for (size_t i = depth_; i < depth; i++)
+            write_barrier.post();
+
+        depth_ = depth;
+    }
+
     // SINK writes (~sample number)
-    // TODO: write_number_ being atomic is redundant because only one sink can
-    //       be bound to a node, right?
-    uint64_t write_number() const { return write_number_; }
+    uint64_t write_number() const { return write_number_.value; }
 
-    void notifySinkWriteComplete()
+    // SOURCE reads (~sample number of the next sample a SOURCE will read)
+    uint64_t read_number(size_t index) const
     {
-        mutex_.wait();
+        return slots_[index].read_number.load(std::memory_order_relaxed);
+    }
 
-        // Require one read from all connected sources
-        source_read_required_ = source_slots_;
+    /**
+     * @brief Publish a write to all bound SOURCES. Only the SINK calls this,
+     * so the SINK is the only writer of active_ and write_number_. Its cost
+     * scales with the number of active SOURCES, not the number of slots.
+     */
+    void notifySinkWriteComplete()
+    {
+        const uint64_t w = write_number_.value.load(std::memory_order_relaxed);
+        auto &required = source_read_required_[w % depth_];
+
+        uint32_t words_left = 0;
+        mask_t any_active = 0;
+        for (size_t k = 0; k < num_words_; k++) {
+
+            // Admit SOURCES that have joined since the last write. They start
+            // reading at this one.
+            const mask_t joined = joining_.value[k].exchange(0);
+            for (mask_t m = joined; m; m &= m - 1)
+                slots_[slotIndex(k, m)].read_number.store(
+                        w, std::memory_order_relaxed);
+
+            // Drop SOURCES that have left and acknowledge their departure
+            const mask_t left = leaving_.value[k].load();
+            const mask_t active = (active_.value[k].load(std::memory_order_relaxed)
+                                   | joined) & ~left;
+            active_.value[k].store(active, std::memory_order_relaxed);
+            if (left)
+                leaving_.value[k].fetch_and(~left);
+
+            // Require one read of this ring slot from all active sources
+            required.words[k].store(active);
+            words_left += (active != 0);
+            any_active |= active;
+        }
+        required.words_left.store(words_left);
 
         // Tell each source connected to the node that it may read
-        for (size_t i = 0; i < source_slots_.size(); i++)
-            if (source_slots_[i])
-                read_barrier(i).post();
+        for (size_t k = 0; k < num_words_; k++) {
+            for (mask_t m = active_.value[k].load(std::memory_order_relaxed);
+                 m; m &= m - 1)
+                slots_[slotIndex(k, m)].read_barrier.post();
+        }
+
+        write_number_.value.store(w + 1);
 
-        ++write_number_;
+        // A SOURCE that started leaving after active was computed may have
+        // missed this write when giving up its reads. Give them up for it.
+        for (size_t k = 0; k < num_words_; k++) {
+            const mask_t stale = active_.value[k].load(std::memory_order_relaxed)
+                                 & leaving_.value[k].load();
+            if (stale && clearReadRequired(w, k, stale))
+                write_barrier.post();
+        }
 
-        mutex_.post();
+        // No one will read this slot, so it is free again immediately
+        if (any_active == 0)
+            write_barrier.post();
     }
 
     // SOURCE read counting
     bool notifySourceReadComplete(size_t index)
     {
-        mutex_.wait();
+        auto &cursor = slots_[index].read_number;
+        const auto n = cursor.load(std::memory_order_relaxed);
+        cursor.store(n + 1, std::memory_order_relaxed);
 
-        source_read_required_[index] = false;
-        bool reads_finished = source_read_required_.none();
+        // The last reader of a ring slot is the one whose bit empties it
+        return clearReadRequired(n, index / MASK_BITS, bitOf(index));
+    }
 
-        mutex_.post();
+    /**
+     * @brief Allocate a SOURCE slot.
+     * @param index Index of the allocated slot
+     * @param owner PID of the process that will hold the slot. Slots with an
+     * owner are reclaimed by the SINK if that process dies.
+     * @return 0 on success, -1 if all slots are in use.
+     */
+    int acquireSlot(size_t &index, const int32_t owner = 0)
+    {
+        for (size_t k = 0; k < num_words_; k++) {
+
+            auto &allocated = allocated_.value[k];
+            mask_t slots = allocated.load();
+            mask_t bit;
+            bool found = true;
+            do {
+                // Slots that have been released but not yet acknowledged by
+                // the SINK cannot be reused
+                const mask_t free = ~(slots | leaving_.value[k].load())
+                                    & wordMask(k);
+                if (!free) {
+                    found = false;
+                    break;
+                }
+
+                index = slotIndex(k, free);
+                bit = bitOf(index);
+
+            } while (!allocated.compare_exchange_weak(slots, slots | bit));
+
+            if (!found)
+                continue;
+
+            // Clear read tokens left by a previous occupant of this slot. The
+            // SINK stopped posting them when it acknowledged its departure.
+            while (slots_[index].read_barrier.try_wait()) { }
+            slots_[index].counters.reset(owner);
+            slots_[index].owner.claim(owner);
+
+            // Reads start once the SINK admits this source on its next write
+            slots_[index].read_number.store(NOT_ADMITTED);
+            joining_.value[k].fetch_or(bit);
+
+            return 0;
+        }
 
-        return reads_finished;
+        return -1;
     }
 
-    // SOURCE slots
-    static constexpr size_t NUM_SLOTS {10};
-
-    int acquireSlot(size_t &index)
+    int releaseSlot(size_t index)
     {
-        mutex_.wait();
-
-        if (source_slots_.all()) {
-            mutex_.post();
+        if (index >= num_slots_)
             return -1;
-        }
 
-        index = 0;
-        while (source_slots_[index])
-            ++index;
+        const size_t k = index / MASK_BITS;
+        const mask_t bit = bitOf(index);
+        if (!(allocated_.value[k].load() & bit))
+            return 0;
 
-        source_slots_[index] = true;
-        source_ref_count_ = source_slots_.count();
+        // Never admitted by the SINK: nothing to give up
+        if (joining_.value[k].fetch_and(~bit) & bit) {
+            freeSlot(index);
+            return 0;
+        }
+
+        // Give up reads of samples this source never got to so that the SINK
+        // does not wait on them
+        leaving_.value[k].fetch_or(bit);
+        const uint64_t n = write_number_.value.load();
+        for (auto i = slots_[index].read_number.load(); i < n; i++) {
+            if (clearReadRequired(i, k, bit))
+                write_barrier.post();
+        }
 
-        mutex_.post();
+        freeSlot(index);
 
         return 0;
     }
 
-    int releaseSlot(size_t index)
+    /**
+     * @brief Release the slots of SOURCES whose process has died so that
+     * the SINK stops waiting on them and the slots can be reused. Only the
+     * SINK calls this, never while it is writing.
+     * @return Number of slots that were reclaimed
+     */
+    size_t reapSources(void)
     {
-        if (index >= source_slots_.size())
-            return -1;
+        size_t reaped = 0;
+        for (size_t k = 0; k < num_words_; k++) {
+
+            const mask_t held = allocated_.value[k].load()
+                                & ~leaving_.value[k].load();
+            for (mask_t m = held; m; m &= m - 1) {
+
+                const size_t index = slotIndex(k, m);
+                auto &owner = slots_[index].owner;
+                int32_t pid = owner.pid.load();
+                if (!owner.dead() || !owner.pid.compare_exchange_strong(pid, 0))
+                    continue;
+
+                reclaimSlot(index);
+                reaped++;
+            }
+        }
 
-        mutex_.wait();
-        source_slots_[index] = false;
-        source_ref_count_ = source_slots_.count();
-        mutex_.post();
+        return reaped;
+    }
 
-        return 0;
+    bool slot_in_use(const size_t index) const
+    {
+        return index < num_slots_
+               && (allocated_.value[index / MASK_BITS].load() & bitOf(index))
+               && !(leaving_.value[index / MASK_BITS].load() & bitOf(index));
     }
 
-    size_t source_ref_count(void) const { return source_ref_count_; }
+    size_t source_ref_count(void) const
+    {
+        size_t count = 0;
+        for (size_t k = 0; k < num_words_; k++)
+            count += __builtin_popcountll(allocated_.value[k].load()
+                                          & ~leaving_.value[k].load());
+        return count;
+    }
 
     // Synchronization constructs
-    // write _always_ occurs before read. By starting at 1, the writer is not
-    // blocked by an initial wait. Readers to do not post to the write_barrier
-    // until a write occurs.
-    semaphore write_barrier {1};
-
-    // This method is required because an std::array of semaphores requires
-    // each semaphore to be copy-constructed to initialized the array.
-    // Because of their nature, semaphores are NOT copy constructable, so
-    // this approach does not work.
+    // write _always_ occurs before read. By starting at 1 (and being posted
+    // up to depth_ when the SINK binds), the writer is not blocked by an
+    // initial wait. Readers to do not post to the write_barrier until a write
+    // occurs and they are the last to read its slot.
+    alignas(CACHE_LINE_SIZE) semaphore write_barrier {1};
+
     semaphore &read_barrier(size_t index)
     {
-        if (!source_slots_[index])
+        if (index >= num_slots_
+            || !(allocated_.value[index / MASK_BITS].load() & bitOf(index)))
             throw std::runtime_error("Requested index refers to a SOURCE "
                                      "that is not bound to this node.");
 
-        switch (index) {
-            case 0: return rb0_; break;
-            case 1: return rb1_; break;
-            case 2: return rb2_; break;
-            case 3: return rb3_; break;
-            case 4: return rb4_; break;
-            case 6: return rb6_; break;
-            case 7: return rb7_; break;
-            case 8: return rb8_; break;
-            case 9: return rb9_; break;
-            default:
-                throw std::runtime_error("Source index out of range.");
-                break;
-        }
+        return slots_[index].read_barrier;
+    }
+
+    // Owning processes of each end of the node
+    Owner &sink_owner(void) { return sink_owner_; }
+    const Owner &sink_owner(void) const { return sink_owner_; }
+    Owner &source_owner(size_t index) { return slots_[index].owner; }
+
+    // Performance counters. Only the SINK writes its counters and each
+    // SOURCE only writes those of its own slot.
+    Counters &sink_counters(void) { return sink_counters_; }
+    const Counters &sink_counters(void) const { return sink_counters_; }
+    Counters &source_counters(size_t index) { return slots_[index].counters; }
+    const Counters &source_counters(size_t index) const
+    {
+        return slots_[index].counters;
     }
 
 private:
 
-    std::atomic<NodeState> sink_state_ {oat::NodeState::UNDEFINED}; //!< SINK state
-    //std::atomic<size_t> source_read_count_ {0}; //!< Number SOURCE reads that have occured since last sink reset
-    std::bitset<NUM_SLOTS> source_slots_;
-    std::bitset<NUM_SLOTS> source_read_required_;
+    static constexpr size_t MASK_BITS {64};
+    static constexpr size_t MAX_WORDS {MAX_SLOTS / MASK_BITS};
+    static_assert(MAX_SLOTS % MASK_BITS == 0,
+                  "MAX_SLOTS must be a multiple of the mask width.");
+    static constexpr uint64_t NOT_ADMITTED {std::numeric_limits<uint64_t>::max()};
+
+    using mask_array_t = std::array<std::atomic<mask_t>, MAX_WORDS>;
+
+    // SOURCES that must read a ring slot before it can be rewritten, along
+    // with the number of non-empty mask words so that the last reader can be
+    // identified without scanning every word
+    struct alignas(CACHE_LINE_SIZE) ReadRequired {
+        std::atomic<uint32_t> words_left;
+        mask_array_t words;
+    };
+
+    static mask_t bitOf(const size_t index)
+    {
+        return mask_t{1} << (index % MASK_BITS);
+    }
+
+    // Index of the lowest set bit of m, which is word k of a mask
+    static size_t slotIndex(const size_t k, const mask_t m)
+    {
+        return k * MASK_BITS + __builtin_ctzll(m);
+    }
+
+    // Bits of mask word k that correspond to existing slots
+    mask_t wordMask(const size_t k) const
+    {
+        const size_t n = num_slots_ - k * MASK_BITS;
+        return n >= MASK_BITS ? ~mask_t{0} : (mask_t{1} << n) - 1;
+    }
+
+    /**
+     * @brief Clear bits from word k of the read requirement of a write.
+     * @return True if this emptied the requirement, in which case the caller
+     * is responsible for posting the write barrier.
+     */
+    bool clearReadRequired(const uint64_t write, const size_t k,
+                           const mask_t bits)
+    {
+        auto &required = source_read_required_[write % depth_];
+        const mask_t prev = required.words[k].fetch_and(~bits);
+        if (!(prev & bits) || (prev & ~bits))
+            return false;
 
-    size_t source_ref_count_ {0}; //!< Number of SOURCES sharing this node
-    uint64_t write_number_ {0}; //!< Number of writes to shmem that have been facilited by this node
+        return required.words_left.fetch_sub(1) == 1;
+    }
 
-    // Unfortunately, must manually maintain the number of rbx_'s to match NUM_SLOTS
-    semaphore mutex_ {1}; //!< mutex governing exclusive acces to the read_barrier_
-    semaphore rb0_ {0}, rb1_ {0}, rb2_ {0}, rb3_ {0}, rb4_ {0},
-              rb5_ {0}, rb6_ {0}, rb7_ {0}, rb8_ {0}, rb9_ {0};
+    void freeSlot(const size_t index)
+    {
+        slots_[index].owner.pid.store(0);
+        allocated_.value[index / MASK_BITS].fetch_and(~bitOf(index));
+    }
+
+    // Release the slot of a SOURCE that died. It may have died part way
+    // through a read, so its read number cannot be trusted. Instead, give up
+    // its reads of every ring slot that could still be waiting on it.
+    void reclaimSlot(const size_t index)
+    {
+        const size_t k = index / MASK_BITS;
+        const mask_t bit = bitOf(index);
+
+        if (joining_.value[k].fetch_and(~bit) & bit) {
+            freeSlot(index);
+            return;
+        }
+
+        leaving_.value[k].fetch_or(bit);
+        const uint64_t n = write_number_.value.load();
+        for (auto i = n > depth_ ? n - depth_ : 0; i < n; i++) {
+            if (clearReadRequired(i, k, bit))
+                write_barrier.post();
+        }
+
+        freeSlot(index);
+    }
+
+    void closeBarriers(void)
+    {
+        write_barrier.close();
+        for (size_t i = 0; i < num_slots_; i++)
+            slots_[i].read_barrier.close();
+    }
+
+    std::atomic<NodeState> sink_state_ {oat::NodeState::UNDEFINED}; //!< SINK state
+    std::atomic<bool> reconnectable_ {false}; //!< Stream survives the SINK
+    size_t depth_ {1}; //!< Number of object slots in the ring
+
+    // Fixed at creation
+    const uint64_t id_ {Counters::now()}; //!< Distinguishes nodes that reuse an address
+    const bip::offset_ptr<Slot> slots_; //!< SOURCE slots
+    const size_t num_slots_; //!< Number of SOURCE slots
+    const size_t num_words_; //!< Number of mask words in use
+
+    // Written by the SINK on every write
+    Counters sink_counters_;
+    Owner sink_owner_;
+    std::atomic<bool> sink_writing_ {false}; //!< SINK holds a ring slot
+    CacheAligned<std::atomic<uint64_t>> write_number_ {0}; //!< Number of writes to shmem that have been facilited by this node
+    CacheAligned<mask_array_t> active_; //!< SOURCES admitted by the SINK
+
+    // Written by SOURCES when they join or leave
+    CacheAligned<mask_array_t> allocated_; //!< Allocated SOURCE slots
+    CacheAligned<mask_array_t> joining_; //!< Awaiting admission by the SINK
+    CacheAligned<mask_array_t> leaving_; //!< Awaiting acknowledgement by the SINK
+
+    // Written by the SINK and the SOURCES reading each ring slot
+    std::array<ReadRequired, MAX_DEPTH> source_read_required_;
 };
 
 }       /* namespace oat */
@@ -0,0 +1,141 @@
+//******************************************************************************
+//* File:   SegmentOptions.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SEGMENTOPTIONS_H
+#define	OAT_SEGMENTOPTIONS_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace oat {
+
+/**
+ * @brief Memory options for a shared object segment. Each is a request:
+ * applySegmentOptions() reports which of them actually took effect.
+ */
+struct SegmentOptions {
+    bool huge_pages {false}; //!< Back the segment with transparent huge pages
+    bool prefault {false}; //!< Fault in every page when the segment is mapped
+    bool lock {false}; //!< Lock the segment into RAM
+};
+
+// Transparent huge page size on the platforms we support
+static constexpr size_t HUGE_PAGE_SIZE {2 * 1024 * 1024};
+
+/**
+ * @brief Round a segment size up so that, if huge pages are requested, the
+ * segment does not end in a partially used huge page.
+ * @param bytes Required segment size
+ * @param options Requested segment options
+ * @return Segment size in bytes
+ */
+inline size_t segmentSize(const size_t bytes, const SegmentOptions &options)
+{
+    if (!options.huge_pages)
+        return bytes;
+
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+/**
+ * @brief Check if the kernel will back POSIX shared memory with transparent
+ * huge pages when asked to with madvise().
+ */
+inline bool shmemHugePagesAvailable(void)
+{
+    static const bool available = [] {
+        std::ifstream f("/sys/kernel/mm/transparent_hugepage/shmem_enabled");
+        std::string setting;
+        while (f >> setting) {
+            // The active setting is bracketed
+            if (setting.front() == '[')
+                return setting != "[never]" && setting != "[deny]";
+        }
+        return false;
+    }();
+
+    return available;
+}
+
+/**
+ * @brief Apply memory options to a mapped shared memory segment. Options
+ * that cannot be honored, e.g. because huge pages are disabled or the memory
+ * lock limit is too small, are skipped.
+ * @param addr Page aligned address of the mapping
+ * @param bytes Size of the mapping
+ * @param requested Requested options
+ * @param writable True if the caller will write to the segment. Prefaulting
+ * a segment that is only read will not allocate its pages.
+ * @return The options that took effect.
+ */
+inline SegmentOptions applySegmentOptions(void *addr,
+                                          const size_t bytes,
+                                          const SegmentOptions &requested,
+                                          const bool writable)
+{
+    SegmentOptions applied;
+
+#ifdef __linux__
+
+    // Must precede any faults so that they allocate huge pages
+    if (requested.huge_pages && shmemHugePagesAvailable())
+        applied.huge_pages = madvise(addr, bytes, MADV_HUGEPAGE) == 0;
+
+    if (requested.prefault) {
+
+#ifdef MADV_POPULATE_WRITE
+        applied.prefault = madvise(addr, bytes, writable ? MADV_POPULATE_WRITE
+                                                         : MADV_POPULATE_READ) == 0;
+#endif
+        // Older kernels: touch each page
+        if (!applied.prefault) {
+            const size_t page = sysconf(_SC_PAGESIZE);
+            volatile char *p = static_cast<volatile char *>(addr);
+            for (size_t i = 0; i < bytes; i += page) {
+                if (writable)
+                    p[i] = p[i];
+                else
+                    (void)p[i];
+            }
+            applied.prefault = true;
+        }
+    }
+
+    // Also faults in any pages that are not yet resident
+    if (requested.lock)
+        applied.lock = mlock(addr, bytes) == 0;
+
+#else
+    (void)addr;
+    (void)bytes;
+    (void)requested;
+    (void)writable;
+#endif
+
+    return applied;
+}
+
+}       /* namespace oat */
+#endif	/* OAT_SEGMENTOPTIONS_H */
@@ -0,0 +1,306 @@
+//******************************************************************************
+//* File:   Semaphore.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SEMAPHORE_H
+#define	OAT_SEMAPHORE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <boost/interprocess/exceptions.hpp>
+
+#include "ForwardsDecl.h"
+
+namespace oat {
+
+/**
+ * @brief Interprocess counting semaphore that lives in shared memory.
+ *
+ * wait() spins for a short, adaptively tuned number of iterations before
+ * parking the calling thread on a futex. A post() only enters the kernel if
+ * there is a parked waiter. close() wakes all waiters at once and causes
+ * further calls to wait() to return false once the count is exhausted.
+ *
+ * A wait() that is interrupted by a signal goes back to waiting unless the
+ * quit flag registered with setQuitFlag() is set, in which case it throws a
+ * bip::interprocess_exception with error code 1, the same way that
+ * bip::interprocess_semaphore does on SIGINT. Other signals (SIGCHLD,
+ * SIGWINCH, profiler ticks, etc.) are not mistaken for a request to quit. If
+ * no flag is registered, any interrupting signal causes wait() to throw.
+ */
+class Semaphore {
+public:
+
+    explicit Semaphore(const uint32_t initial_count)
+    : count_(initial_count)
+    {
+        // Nothing
+    }
+
+    // Semaphores are not copyable or movable
+    Semaphore(const Semaphore &) = delete;
+    Semaphore & operator=(const Semaphore &) = delete;
+
+    void post()
+    {
+        count_.fetch_add(1, std::memory_order_release);
+        seq_.fetch_add(1);
+
+        if (waiters_.load() > 0)
+            wake(1);
+    }
+
+    bool try_wait()
+    {
+        auto c = count_.load(std::memory_order_relaxed);
+        while (c > 0) {
+            if (count_.compare_exchange_weak(c, c - 1,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed))
+                return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Result of a timed_wait()
+     */
+    enum class Status {
+        ACQUIRED,
+        CLOSED,
+        TIMEOUT
+    };
+
+    /**
+     * @brief Decrement the count, blocking until it is positive.
+     * @return false if the semaphore was closed and its count is exhausted,
+     * true otherwise.
+     */
+    bool wait()
+    {
+        return timed_wait(0) == Status::ACQUIRED;
+    }
+
+    /**
+     * @brief Decrement the count, blocking until it is positive or the
+     * timeout expires.
+     * @param timeout_ns Maximum time to block in nanoseconds. 0 blocks
+     * indefinitely.
+     * @return Status::CLOSED if the semaphore was closed and its count is
+     * exhausted, Status::TIMEOUT if the timeout expired first.
+     */
+    Status timed_wait(const uint64_t timeout_ns)
+    {
+        // Spin first: at high sample rates the post usually arrives within a
+        // few microseconds and parking would cost more than it saves. On a
+        // uniprocessor the poster cannot run while we spin, so don't.
+        static const bool can_spin = std::thread::hardware_concurrency() > 1;
+        const auto limit = can_spin
+                         ? spin_limit_.load(std::memory_order_relaxed) : 0;
+        for (uint32_t i = 0; i < limit; i++) {
+
+            if (try_wait()) {
+                adaptSpinLimit(limit, 2 * i + MIN_SPIN);
+                return Status::ACQUIRED;
+            }
+
+            if (closed_.load(std::memory_order_acquire))
+                return try_wait() ? Status::ACQUIRED : Status::CLOSED;
+
+            relax();
+        }
+
+        if (can_spin)
+            adaptSpinLimit(limit, MIN_SPIN);
+
+        // Park
+        using clock = std::chrono::steady_clock;
+        const auto deadline = clock::now() + std::chrono::nanoseconds(timeout_ns);
+        waiters_.fetch_add(1);
+        Status status = Status::TIMEOUT;
+        while (true) {
+
+            // seq_ must be sampled before the count is checked so that a
+            // post() in between causes the futex wait to return immediately
+            const auto seq = seq_.load();
+
+            if (try_wait()) {
+                status = Status::ACQUIRED;
+                break;
+            }
+
+            if (closed_.load(std::memory_order_acquire)) {
+                status = Status::CLOSED;
+                break;
+            }
+
+            // Checked on every pass, not just after EINTR, so that a signal
+            // that lands between passes is not missed
+            if (quitRequested()) {
+                waiters_.fetch_sub(1);
+                throw bip::interprocess_exception(
+                        bip::error_info(bip::system_error));
+            }
+
+            long nsec = PARK_NSEC;
+            if (timeout_ns > 0) {
+                const auto left = std::chrono::duration_cast<
+                        std::chrono::nanoseconds>(deadline - clock::now()).count();
+                if (left <= 0)
+                    break;
+                nsec = std::min<long>(nsec, left);
+            }
+
+            // Without a quit flag there is no way to tell SIGINT apart from
+            // any other signal
+            if (!park(seq, nsec) && quitFlag().load() == nullptr) {
+                waiters_.fetch_sub(1);
+                throw bip::interprocess_exception(
+                        bip::error_info(bip::system_error));
+            }
+        }
+        waiters_.fetch_sub(1);
+
+        return status;
+    }
+
+    /**
+     * @brief Wake all waiters. Subsequent calls to wait() will not block.
+     */
+    void close()
+    {
+        closed_.store(true, std::memory_order_release);
+        seq_.fetch_add(1);
+        wake(INT32_MAX);
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Register the flag that this process's SIGINT handler sets.
+     * Waits in this process throw once it is set rather than on any signal.
+     * @param quit Quit flag, which must outlive all waits. nullptr to
+     * unregister.
+     */
+    static void setQuitFlag(volatile sig_atomic_t *quit)
+    {
+        quitFlag().store(quit);
+    }
+
+private:
+
+    // Spin iteration bounds
+    static constexpr uint32_t MIN_SPIN {16};
+    static constexpr uint32_t MAX_SPIN {16384};
+
+    // Upper bound on a single park. A lost wakeup is not possible, but this
+    // guarantees that a waiting thread will periodically re-check state.
+    static constexpr long PARK_NSEC {100000000};
+
+    std::atomic<uint32_t> count_;
+    std::atomic<uint32_t> seq_ {0}; //!< Futex word, bumped by post() and close()
+    std::atomic<uint32_t> waiters_ {0}; //!< Number of parked threads
+    std::atomic<uint32_t> spin_limit_ {1024};
+    std::atomic<bool> closed_ {false};
+
+    // Move the spin limit 1/8 of the way toward the number of spins that
+    // would have been sufficient
+    void adaptSpinLimit(const uint32_t limit, const uint32_t target)
+    {
+        int64_t next = static_cast<int64_t>(limit)
+                     + (static_cast<int64_t>(target) - limit) / 8;
+        next = std::max<int64_t>(MIN_SPIN, std::min<int64_t>(MAX_SPIN, next));
+        spin_limit_.store(static_cast<uint32_t>(next),
+                          std::memory_order_relaxed);
+    }
+
+    // Per-process, so it must not be a member of this shared memory object
+    static std::atomic<volatile sig_atomic_t *> &quitFlag()
+    {
+        static std::atomic<volatile sig_atomic_t *> quit {nullptr};
+        return quit;
+    }
+
+    static bool quitRequested()
+    {
+        const auto quit = quitFlag().load();
+        return quit != nullptr && *quit;
+    }
+
+    static void relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#endif
+    }
+
+#ifdef __linux__
+
+    // Shared (non-private) futex operations so that waiters in different
+    // processes mapping the same segment can be woken
+    void wake(const int n)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&seq_),
+                FUTEX_WAKE, n, nullptr, nullptr, 0);
+    }
+
+    // Returns false if interrupted by a signal
+    bool park(const uint32_t seq, const long nsec)
+    {
+        struct timespec timeout {0, nsec};
+        auto rc = syscall(SYS_futex, reinterpret_cast<uint32_t *>(&seq_),
+                          FUTEX_WAIT, seq, &timeout, nullptr, 0);
+
+        return !(rc == -1 && errno == EINTR);
+    }
+
+#else
+
+    void wake(const int) { }
+
+    // No futex: poll with a short sleep
+    bool park(const uint32_t seq, const long nsec)
+    {
+        if (seq_.load() == seq)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(
+                    std::min<long>(nsec, 100000)));
+
+        return true;
+    }
+
+#endif
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SEMAPHORE_H */
@@ -24,6 +24,7 @@
 #include <boost/interprocess/managed_shared_memory.hpp>
 
 #include "../datatypes/Color.h"
+#include "SegmentOptions.h"
 
 namespace oat {
 namespace bip = boost::interprocess;
@@ -57,6 +58,11 @@ public :
     handle_t data() const { return data_; }
     FrameParams params() const { return params_; }
 
+    // Memory options requested by the SINK, to be applied by SOURCES to
+    // their own mappings of the segment
+    SegmentOptions segment_options() const { return segment_options_; }
+    void set_segment_options(const SegmentOptions &val) { segment_options_ = val; }
+
     /**
      * Set header data fields.
      *
@@ -94,6 +100,9 @@ private :
     // Interprocess matrix data and sample handles
     handle_t data_;
     handle_t sample_;
+
+    // Segment memory options
+    SegmentOptions segment_options_;
 };
 
 }       /* namespace oat */
@@ -21,16 +21,20 @@
 #define	OAT_SINK_H
 
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/thread/thread_time.hpp>
 #include <iostream>
+#include <unistd.h>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "../datatypes/Color.h"
 #include "../datatypes/Frame.h"
 #include "../datatypes/Sample.h"
 
+#include "Arena.h"
 #include "ForwardsDecl.h"
+#include "Lease.h"
+#include "LocalNode.h"
 #include "Node.h"
 #include "SharedFrameHeader.h"
 
@@ -49,14 +53,68 @@ public:
     void wait();
     void post();
 
+    /**
+     * @brief Set the maximum number of SOURCES that can read from the node
+     * this SINK binds. Must be called before bind(). Has no effect if the
+     * node was already created by a SOURCE with at least this many slots.
+     * @param n Maximum number of SOURCES
+     */
+    void set_max_sources(const size_t n);
+
+    /**
+     * @brief Leave the stream open for a new SINK to resume when this one is
+     * destroyed, rather than ending it. SOURCES keep waiting in the meantime.
+     * Defaults to true if OAT_RECONNECT is set in the environment. Must be
+     * called before bind().
+     * @param value True to make the SINK reconnectable
+     */
+    void set_reconnectable(const bool value);
+
+    /**
+     * @brief Check if bind() resumed a stream left by a previous SINK rather
+     * than starting a new one.
+     */
+    bool resumed() const { return resumed_; }
+
 protected:
 
+    // Find or create the node at node_address_, or the local node reserved
+    // at address_, and make sure it has room for the requested number of
+    // SOURCES
+    void openNode(void);
+    void openSharedNode(void);
+
+    // True if the node was left by a reconnectable SINK whose stream this
+    // one can take over
+    bool resumable(void) const
+    {
+        return node_->sink_gone() && node_->reconnectable();
+    }
+
+    // Open the object segment of a stream being resumed and find the count
+    // shared objects that the previous SINK constructed
+    template<typename U>
+    U * openResumed(const size_t count, const size_t depth);
+
+    // Become the node's SINK
+    void claimNode(void);
+
+    // Index of the ring slot that the next write will occupy
+    size_t write_slot(void) const
+    {
+        return node_->write_number() % node_->depth();
+    }
+
     std::string address_;
     shmem_t node_shmem_, obj_shmem_;
+    std::shared_ptr<LocalNode> local_;
     Node * node_ {nullptr};
     T * sh_object_ {nullptr};
     std::string node_address_, obj_address_;
     bool bound_ {false};
+    bool reconnectable_ {Node::reconnectByDefault()};
+    bool resumed_ {false};
+    size_t num_slots_ {Node::DEFAULT_SLOTS};
 
 private:
     bool did_wait_need_post_ {false};
@@ -74,12 +132,18 @@ inline SinkBase<T>::~SinkBase() {
     // Detach this server from shared mat header
     if (bound_) {
 
-        node_->set_sink_state(NodeState::END);
+        if (reconnectable_)
+            node_->detachSink();
+        else
+            node_->set_sink_state(NodeState::END);
+
+        // SOURCES that died while attached should not keep the segments alive
+        node_->reapSources();
 
-        // If the client ref count is 0, memory can be deallocated
-        if (node_->source_ref_count() == 0 &&
-            bip::shared_memory_object::remove(node_address_.c_str()) &&
-            bip::shared_memory_object::remove(obj_address_.c_str())) {
+        // If the client ref count is 0, memory can be deallocated. A local
+        // node is freed along with the last reference to it.
+        if (!local_ && node_->source_ref_count() == 0 &&
+            node_->unlink(node_address_, obj_address_)) {
 
 #ifndef NDEBUG
         std::cout << "Shared memory at \'" + node_address_ +
@@ -89,6 +153,104 @@ inline SinkBase<T>::~SinkBase() {
     }
 }
 
+template<typename T>
+inline void SinkBase<T>::set_max_sources(const size_t n) {
+
+    if (bound_)
+        throw std::runtime_error("Maximum number of sources must be set "
+                                 "before the sink is bound.");
+
+    if (n < 1 || n > Node::MAX_SLOTS)
+        throw std::runtime_error("Maximum number of sources must be between 1 "
+                                 "and " + std::to_string(Node::MAX_SLOTS) + ".");
+
+    num_slots_ = n;
+}
+
+template<typename T>
+inline void SinkBase<T>::set_reconnectable(const bool value) {
+
+    if (bound_)
+        throw std::runtime_error("Reconnectable mode must be set before the "
+                                 "sink is bound.");
+
+    reconnectable_ = value;
+}
+
+template<typename T>
+inline void SinkBase<T>::openNode() {
+
+    // SOURCES of a local node are threads of this process, so there is no
+    // stream to leave open for another SINK
+    local_ = LocalNode::find(address_);
+    if (local_) {
+        reconnectable_ = false;
+        node_ = &local_->node(num_slots_);
+    } else {
+        openSharedNode();
+    }
+
+    // A SOURCE may have created the node before the SINK bound it
+    if (node_->num_slots() < num_slots_)
+        throw std::runtime_error("Node at '" + address_ + "' was created with "
+                                 "room for only "
+                                 + std::to_string(node_->num_slots())
+                                 + " sources.");
+}
+
+template<typename T>
+inline void SinkBase<T>::openSharedNode() {
+
+    // A previous SINK at this address may have died without cleaning up
+    if (Node::unlinkIfAbandoned(node_address_, obj_address_))
+        std::cerr << "Reclaimed shared memory at '" + address_
+                     + "' from a SINK that exited without releasing it.\n";
+
+    node_shmem_ = bip::managed_shared_memory(
+            bip::open_or_create,
+            node_address_.c_str(),
+            Node::segmentSize(num_slots_));
+
+    // Bind to a node which facilitates synchronized access to shmem
+    node_ = Node::findOrConstruct(node_shmem_, num_slots_);
+}
+
+template<typename T>
+template<typename U>
+inline U * SinkBase<T>::openResumed(const size_t count, const size_t depth) {
+
+    obj_shmem_ = bip::managed_shared_memory(bip::open_only,
+                                            obj_address_.c_str());
+
+    auto found = obj_shmem_.template find<U>(typeid(U).name());
+    if (found.first == nullptr || found.second != count
+        || node_->depth() != depth)
+        throw std::runtime_error("Cannot resume the stream at '" + address_
+                                 + "' because it holds a different token "
+                                 "type or ring depth.");
+
+    resumed_ = true;
+
+    return found.first;
+}
+
+template<typename T>
+inline void SinkBase<T>::claimNode() {
+
+    // A SINK that left part way through a write took a free ring slot with
+    // it
+    if (node_->sink_writing()) {
+        node_->set_sink_writing(false);
+        node_->write_barrier.post();
+    }
+
+    node_->set_reconnectable(reconnectable_);
+    node_->sink_counters().reset(getpid());
+    node_->sink_owner().claim(getpid());
+    node_->set_sink_state(NodeState::SINK_BOUND);
+    bound_ = true;
+}
+
 template<typename T>
 inline void SinkBase<T>::wait() {
 
@@ -100,16 +262,28 @@ inline void SinkBase<T>::wait() {
         throw std::runtime_error("wait() called when post() was required.");
 #endif
 
-    boost::system_time timeout = boost::get_system_time() + msec_t(10);
-
-    // Only wait if there is a SOURCE attached to the node
-    // Wait with timed wait with period check to prevent deadlocks
-    while (node_->source_ref_count() > 0 &&
-          !node_->write_barrier.timed_wait(timeout)) {
-        // Loops checking if wait has been released
-        timeout = boost::get_system_time() + msec_t(10);
+    // Wait for a free ring slot. If there are no SOURCEs attached to the
+    // node, each write frees its own slot so this will not block. A SOURCE
+    // that dies holding a read would block it forever, so periodically check
+    // for them and give up their reads.
+    const uint64_t start = Counters::now();
+    Semaphore::Status status;
+    while ((status = node_->write_barrier.timed_wait(Node::HEARTBEAT_NS))
+           == Semaphore::Status::TIMEOUT) {
+        node_->reapSources();
+        if (LocalNode::cancelled())
+            break;
     }
 
+    // The node was ended underneath this SINK, or the process hosting it is
+    // shutting down. Either way there is no slot to write to, so unwind the
+    // same way as an interrupted wait.
+    if (status != Semaphore::Status::ACQUIRED)
+        throw bip::interprocess_exception(bip::error_info(bip::system_error));
+
+    node_->sink_counters().recordWait(start);
+    node_->set_sink_writing(true);
+
     did_wait_need_post_ = true;
 }
 
@@ -126,6 +300,8 @@ inline void SinkBase<T>::post() {
 
     // Increment the number times this node has facilitated a shmem write
     node_->notifySinkWriteComplete();
+    node_->set_sink_writing(false);
+    node_->sink_counters().recordPost();
 
     did_wait_need_post_ = false;
 
@@ -139,6 +315,16 @@ inline void SinkBase<T>::post() {
 
 // 0. Generic without need for zero-copy storage
 
+/**
+ * @brief Number of samples a SINK may write ahead of its slowest SOURCE.
+ * Explicit wrapper so that it cannot be confused with shared object
+ * constructor arguments passed to Sink<T>::bind.
+ */
+struct RingDepth {
+    explicit RingDepth(const size_t n) : value(n) { }
+    size_t value;
+};
+
 template<typename T>
 class Sink : public SinkBase<T> {
 
@@ -150,11 +336,19 @@ class Sink : public SinkBase<T> {
     using SinkBase<T>::node_;
     using SinkBase<T>::sh_object_;
     using SinkBase<T>::bound_;
+    using SinkBase<T>::write_slot;
+    using SinkBase<T>::openNode;
+    using SinkBase<T>::resumable;
+    using SinkBase<T>::claimNode;
 
 public:
 
     template<typename ...Targs>
     void bind(const std::string &address, Targs... args);
+
+    template<typename ...Targs>
+    void bind(const std::string &address, const RingDepth depth, Targs... args);
+
     T * retrieve();
 
 };
@@ -163,6 +357,15 @@ template<typename T>
 template<typename ...Targs>
 inline void Sink<T>::bind(const std::string &address, Targs... args) {
 
+    bind(address, RingDepth(1), args...);
+}
+
+template<typename T>
+template<typename ...Targs>
+inline void Sink<T>::bind(const std::string &address,
+                          const RingDepth depth,
+                          Targs... args) {
+
     if (bound_)
         throw std::runtime_error("A sink can only bind a "
                                  "single time to a single node.");
@@ -172,17 +375,28 @@ inline void Sink<T>::bind(const std::string &address, Targs... args) {
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
-    // Extra 1024 bytes are used to hold managed shared mem helper objects
-    // (name-object index, internal synchronization objects, internal
-    // variables...)
-    node_shmem_ = bip::managed_shared_memory(
-            bip::open_or_create,
-            node_address_.c_str(),
-            1024 + sizeof(Node));
-
     // Bind to a node which facilitates synchronized access to shmem
-    node_ = node_shmem_.template find_or_construct<Node>(typeid(Node).name())();
+    openNode();
+
+    if (this->local_) {
+
+        if (node_->sink_state() != NodeState::UNDEFINED)
+            throw (std::runtime_error(
+                    "Requested SINK address, '" + address + "', is not available."));
+
+        node_->set_depth(depth.value);
+        sh_object_ = this->local_->template construct<T>(depth.value, args...);
+        claimNode();
+        return;
+    }
+
+    // Take over the shared objects of a reconnectable SINK that has left.
+    // They hold its last writes, so they are not constructed again.
+    if (resumable()) {
+        sh_object_ = this->template openResumed<T>(depth.value, depth.value);
+        claimNode();
+        return;
+    }
 
     // Make sure there is not another SINK using this shmem
     if (node_->sink_state() != NodeState::UNDEFINED) {
@@ -192,15 +406,17 @@ inline void Sink<T>::bind(const std::string &address, Targs... args) {
                 "Requested SINK address, '" + address + "', is not available."));
     } else {
 
+        node_->set_depth(depth.value);
+
         obj_shmem_ = bip::managed_shared_memory(
             bip::create_only,
             obj_address_.c_str(),
-            1024 + sizeof (T));
+            1024 + depth.value * sizeof (T));
 
-        // Find an existing shared object or construct one
-        sh_object_ = obj_shmem_.template find_or_construct<T>(typeid(T).name())(args...);
-        node_->set_sink_state(NodeState::SINK_BOUND);
-        bound_ = true;
+        // Construct one shared object per ring slot
+        sh_object_ = obj_shmem_.template
+            construct<T>(typeid(T).name())[depth.value](args...);
+        claimNode();
     }
 }
 
@@ -213,7 +429,7 @@ inline T * Sink<T>::retrieve() {
         throw (std::runtime_error("SINK must be bound before shared object is retrieved."));
 #endif
 
-    return sh_object_;
+    return sh_object_ + write_slot();
 }
 
 // 1. SharedFrameHeader
@@ -222,12 +438,49 @@ template<>
 class Sink<Frame> : public SinkBase<SharedFrameHeader> {
 
 public:
-    void bind(const std::string &address, const size_t bytes);
+
+    using WriteLease = oat::Lease<SinkBase<SharedFrameHeader>, oat::Frame>;
+
+    void bind(const std::string &address,
+              const size_t bytes,
+              const size_t depth = 1,
+              const SegmentOptions &options = SegmentOptions());
     oat::Frame retrieve(const size_t rows, size_t cols, const int type, const
             oat::PixelColor color);
+
+    /**
+     * @brief Get the frame occupying the ring slot of the next write. Should
+     * be called after each wait() when the node's ring depth is greater than
+     * 1. The sample is carried forward from the previous write so that it can
+     * be incremented as usual.
+     * @return Shared frame to write to.
+     */
+    oat::Frame retrieve();
+
+    /**
+     * @brief Wait for a free ring slot and lease its frame so that it can be
+     * written in place. Releasing the lease posts to the node, so it
+     * replaces the wait()/retrieve()/post() sequence.
+     * @return Lease on the shared frame.
+     */
+    WriteLease acquire();
+
+    /**
+     * @brief Get the memory options that took effect when the SINK bound its
+     * shared frame segment. Requested options that could not be honored are
+     * false.
+     */
+    SegmentOptions segment_options() const { return segment_options_; }
+
+private:
+    std::vector<oat::Frame> frames_;
+    SegmentOptions segment_options_;
 };
 
-inline void Sink<Frame>::bind(const std::string &address, const size_t bytes) {
+inline void Sink<Frame>::bind(const std::string &address,
+                              const size_t bytes,
+                              const size_t depth,
+                              const SegmentOptions &options) {
 
     if (bound_)
         throw std::runtime_error("A sink can only bind a "
@@ -238,14 +491,34 @@ inline void Sink<Frame>::bind(const std::string &address, const size_t bytes) {
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
-    node_shmem_ = bip::managed_shared_memory(
-            bip::open_or_create,
-            node_address_.c_str(),
-            1024  + sizeof(Node));
-
     // Facilitates synchronized access to shmem
-    node_ = node_shmem_.find_or_construct<Node>(typeid(Node).name())();
+    openNode();
+
+    // Frames of a local node are allocated on the heap when they are
+    // retrieved, so none of the segment options apply
+    if (local_) {
+
+        if (node_->sink_state() != NodeState::UNDEFINED)
+            throw (std::runtime_error(
+                    "Requested SINK address, '" + address + "', is not available."));
+
+        node_->set_depth(depth);
+        segment_options_ = SegmentOptions();
+        claimNode();
+        return;
+    }
+
+    // Take over the frames of a reconnectable SINK that has left. Their
+    // format is checked when they are retrieved.
+    if (resumable()) {
+        sh_object_ = openResumed<SharedFrameHeader>(1, depth);
+        segment_options_ = applySegmentOptions(obj_shmem_.get_address(),
+                                               obj_shmem_.get_size(),
+                                               sh_object_->segment_options(),
+                                               false);
+        claimNode();
+        return;
+    }
 
     // Make sure there is not another SINK using this shmem
     if (node_->sink_state() != NodeState::UNDEFINED) {
@@ -255,17 +528,28 @@ inline void Sink<Frame>::bind(const std::string &address, const size_t bytes) {
                 "Requested SINK address, '" + address + "', is not available."));
     } else {
 
-        // Object shared memory
+        node_->set_depth(depth);
+
+        // Object shared memory: one frame and sample per ring slot
         obj_shmem_ = bip::managed_shared_memory(
             bip::create_only,
             obj_address_.c_str(),
-            1024 + sizeof(SharedFrameHeader) + bytes + sizeof(uint64_t));
+            segmentSize(1024 + sizeof(SharedFrameHeader)
+                             + depth * (bytes + sizeof(oat::Sample)),
+                        options));
+
+        // Back, fault in and lock the pages of the whole segment before any
+        // frame is written so that this is not paid for during acquisition
+        segment_options_ = applySegmentOptions(obj_shmem_.get_address(),
+                                               obj_shmem_.get_size(),
+                                               options,
+                                               true);
 
         // Find an existing shared object or construct one
         sh_object_ = obj_shmem_.find_or_construct<SharedFrameHeader>(typeid(SharedFrameHeader).name())();
+        sh_object_->set_segment_options(options);
 
-        node_->set_sink_state(NodeState::SINK_BOUND);
-        bound_ = true;
+        claimNode();
     }
 }
 
@@ -279,20 +563,217 @@ inline oat::Frame Sink<Frame>::retrieve(const size_t rows,
     if (!bound_)
         throw (std::runtime_error("SINK must be bound before shared frame is retrieved."));
 
-    // Allocate memory for sample number
-    void * sample = obj_shmem_.allocate(sizeof(oat::Sample));
-    handle_t sample_handle = obj_shmem_.get_handle_from_address(sample);
+    const size_t depth = node_->depth();
+
+    // Frames of a local node are reference counted matrices that SOURCES
+    // wrap directly
+    if (local_) {
+
+        auto local = local_->construct<LocalFrames>(1);
+        local->color = color;
+        local->samples.resize(depth);
+
+        frames_.clear();
+        for (size_t i = 0; i < depth; i++) {
+            local->data.emplace_back(rows, cols, type);
+            frames_.emplace_back(local->data[i], color, &local->samples[i]);
+        }
+
+        return frames_[0];
+    }
 
-    // Allocate memory for the shared object's data
     cv::Mat temp(rows, cols, type);
-    void * data = obj_shmem_.allocate(temp.total() * temp.elemSize());
-    handle_t data_handle = obj_shmem_.get_handle_from_address(data);
+    const size_t bytes = temp.total() * temp.elemSize();
+    void * sample {nullptr};
+    void * data {nullptr};
+
+    if (resumed_) {
 
-    // Reset the SharedFrameHeader's parameters now that we know what they should be
-    sh_object_->setParameters(data_handle, sample_handle, rows, cols, type, color);
+        // SOURCES already point at the previous SINK's frames, so only a SINK
+        // producing the same format can take them over
+        const auto p = sh_object_->params();
+        if (p.rows != rows || p.cols != cols || p.type != type || p.color != color)
+            throw (std::runtime_error("Cannot resume the stream at '" + address_
+                                      + "' with frames of a different format."));
+
+        sample = obj_shmem_.get_address_from_handle(sh_object_->sample());
+        data = obj_shmem_.get_address_from_handle(sh_object_->data());
+
+    } else {
+
+        // Allocate memory for sample numbers, one per ring slot
+        sample = obj_shmem_.allocate(depth * sizeof(oat::Sample));
+        handle_t sample_handle = obj_shmem_.get_handle_from_address(sample);
+
+        // Allocate contiguous memory for the shared objects' data
+        data = obj_shmem_.allocate(depth * bytes);
+        handle_t data_handle = obj_shmem_.get_handle_from_address(data);
+
+        // Reset the SharedFrameHeader's parameters now that we know what they should be
+        sh_object_->setParameters(data_handle, sample_handle, rows, cols, type, color);
+    }
+
+    // Frame headers pointing to each ring slot
+    frames_.clear();
+    for (size_t i = 0; i < depth; i++) {
+        frames_.emplace_back(rows, cols, type, color,
+                             static_cast<char *>(data) + i * bytes,
+                             static_cast<oat::Sample *>(sample) + i);
+    }
 
     // Return pointer to memory allocated for shared object
-    return oat::Frame(rows, cols, type, color, data, sample);
+    return frames_[0];
+}
+
+inline oat::Frame Sink<Frame>::retrieve()
+{
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if (frames_.empty())
+        throw (std::runtime_error("SINK must allocate shared frame before it is retrieved."));
+#endif
+
+    const size_t depth = frames_.size();
+    const uint64_t n = node_->write_number();
+    oat::Frame &frame = frames_[n % depth];
+
+    if (depth > 1 && n > 0)
+        frame.set_sample(frames_[(n - 1) % depth].sample());
+
+    return frame;
+}
+
+inline Sink<Frame>::WriteLease Sink<Frame>::acquire()
+{
+    wait();
+
+    return WriteLease(this, retrieve());
+}
+
+// 2. Arena backed, variable size tokens
+
+template<typename T>
+class Sink<Arena<T>> : public SinkBase<Arena<T>> {
+
+    using SinkBase<Arena<T>>::address_;
+    using SinkBase<Arena<T>>::node_address_;
+    using SinkBase<Arena<T>>::obj_address_;
+    using SinkBase<Arena<T>>::obj_shmem_;
+    using SinkBase<Arena<T>>::node_;
+    using SinkBase<Arena<T>>::sh_object_;
+    using SinkBase<Arena<T>>::bound_;
+    using SinkBase<Arena<T>>::write_slot;
+    using SinkBase<Arena<T>>::openNode;
+    using SinkBase<Arena<T>>::resumable;
+    using SinkBase<Arena<T>>::claimNode;
+
+public:
+
+    /**
+     * @brief Bind a node whose ring slots each hold a T and an arena for it
+     * to allocate from.
+     * @param address Node address
+     * @param capacity Bytes available to each write
+     * @param depth Ring depth
+     */
+    void bind(const std::string &address,
+              const size_t capacity,
+              const size_t depth = 1);
+
+    /**
+     * @brief Wait for a free ring slot and reset its arena.
+     */
+    void wait();
+
+    /**
+     * @brief Get the root object occupying the ring slot of the next write.
+     * Anything it allocated during a previous write is gone.
+     */
+    T * retrieve();
+};
+
+template<typename T>
+inline void Sink<Arena<T>>::bind(const std::string &address,
+                                 const size_t capacity,
+                                 const size_t depth) {
+
+    if (bound_)
+        throw std::runtime_error("A sink can only bind a "
+                                 "single time to a single node.");
+
+    // Addresses for this block of shared memory
+    address_ = address;
+    node_address_ = address + "_node";
+    obj_address_ = address + "_obj";
+
+    // Facilitates synchronized access to shmem
+    openNode();
+
+    // Arenas are carved out of a shared memory segment
+    if (this->local_)
+        throw std::runtime_error("Arena backed node at '" + address
+                                 + "' cannot be made local.");
+
+    // Take over the arenas of a reconnectable SINK that has left
+    if (resumable()) {
+        sh_object_ = this->template openResumed<Arena<T>>(depth, depth);
+        if (sh_object_[0].capacity() != capacity)
+            throw std::runtime_error("Cannot resume the stream at '" + address
+                                     + "' with a different arena capacity.");
+        claimNode();
+        return;
+    }
+
+    // Make sure there is not another SINK using this shmem
+    if (node_->sink_state() != NodeState::UNDEFINED) {
+
+        // There is already a SINK using this shmem
+        throw (std::runtime_error(
+                "Requested SINK address, '" + address + "', is not available."));
+    } else {
+
+        node_->set_depth(depth);
+
+        // Object shared memory: one root and arena per ring slot, plus room
+        // for allocation overhead and alignment
+        obj_shmem_ = bip::managed_shared_memory(
+            bip::create_only,
+            obj_address_.c_str(),
+            1024 + depth * (sizeof(Arena<T>) + capacity + 256));
+
+        sh_object_ = obj_shmem_.template
+            construct<Arena<T>>(typeid(Arena<T>).name())[depth]();
+
+        for (size_t i = 0; i < depth; i++) {
+            sh_object_[i].set_storage(
+                obj_shmem_.allocate_aligned(capacity,
+                                            size_t{ArenaAllocator::ALIGNMENT}),
+                capacity);
+        }
+
+        claimNode();
+    }
+}
+
+template<typename T>
+inline void Sink<Arena<T>>::wait() {
+
+    SinkBase<Arena<T>>::wait();
+
+    // All SOURCES are done with this slot
+    sh_object_[write_slot()].reset();
+}
+
+template<typename T>
+inline T * Sink<Arena<T>>::retrieve() {
+
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if (!bound_)
+        throw (std::runtime_error("SINK must be bound before shared object is retrieved."));
+#endif
+
+    return &sh_object_[write_slot()].value();
 }
 
 } // namespace oat
@@ -20,7 +20,10 @@
 #ifndef OAT_SOURCE_H
 #define	OAT_SOURCE_H
 
+#include "Arena.h"
 #include "ForwardsDecl.h"
+#include "Lease.h"
+#include "LocalNode.h"
 #include "Node.h"
 #include "SharedFrameHeader.h"
 
@@ -30,9 +33,10 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
+#include <unistd.h>
 
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/thread/thread_time.hpp>
 
 #include "../datatypes/Frame.h"
 
@@ -61,6 +65,14 @@ public:
     NodeState wait();
     void post();
 
+    /**
+     * @brief Wait through the gap when the SINK leaves without ending the
+     * stream, until a new SINK resumes it, rather than ending. Defaults to
+     * true if OAT_RECONNECT is set in the environment.
+     * @param value True to make the SOURCE reconnectable
+     */
+    void set_reconnectable(const bool value) { reconnectable_ = value; }
+
     uint64_t write_number() const
     {
         return (node_ == nullptr ? 0 : node_->write_number());
@@ -68,7 +80,18 @@ public:
 
 protected:
 
+    // Index of the ring slot holding the next sample this SOURCE will read
+    size_t read_slot(void) const
+    {
+        return node_->read_number(slot_index_) % node_->depth();
+    }
+
+    // Wait for the SINK's first write if it has not bound the node and made
+    // its shared objects available yet
+    void waitForSink(void);
+
     shmem_t node_shmem_, obj_shmem_;
+    std::shared_ptr<LocalNode> local_;
     T * sh_object_ {nullptr};
     Node * node_ {nullptr};
     std::string address_, node_address_, obj_address_;
@@ -77,6 +100,7 @@ protected:
     bool touched_ {false};
     bool connected_ {false};
     bool did_wait_need_post_ {false};
+    bool reconnectable_ {Node::reconnectByDefault()};
 };
 
 template <typename T>
@@ -94,13 +118,12 @@ inline SourceBase<T>::~SourceBase()
         node_->releaseSlot(slot_index_);
 
     // If the client reference count is 0 and there is no server
-    // attached to the node, deallocate the shmem
-    if ( (node_ != nullptr && node_-> source_ref_count() == 0) &&
+    // attached to the node, deallocate the shmem. A local node is freed
+    // along with the last reference to it.
+    if (!local_ && (node_ != nullptr && node_-> source_ref_count() == 0) &&
         node_->sink_state() != NodeState::SINK_BOUND) {
 
-        bool shmem_freed = false;
-        shmem_freed |= bip::shared_memory_object::remove(node_address_.c_str());
-        shmem_freed |= bip::shared_memory_object::remove(obj_address_.c_str());
+        bool shmem_freed = node_->unlink(node_address_, obj_address_);
 
 #ifndef NDEBUG
         if (shmem_freed)
@@ -122,20 +145,30 @@ inline void SourceBase<T>::touch(const std::string &address)
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
-    // Extra 1024 bytes are used to hold managed shared mem helper objects
-    // (name-object index, internal synchronization objects, internal
-    // variables...)
-    node_shmem_ = bip::managed_shared_memory(
-            bip::open_or_create,
-            node_address_.c_str(),
-            1024 + sizeof(Node));
-
-    // Facilitates synchronized access to shmem
-    node_ = node_shmem_.find_or_construct<Node>(typeid(Node).name())();
+    // SINK of a local node is a thread of this process
+    local_ = LocalNode::find(address_);
+    if (local_) {
+        reconnectable_ = false;
+        node_ = &local_->node(Node::DEFAULT_SLOTS);
+    } else {
+
+        // Don't attach to a node whose SINK died. A restarted SINK will create
+        // a new one.
+        Node::unlinkIfAbandoned(node_address_, obj_address_);
+
+        // Define shared memory. If the SINK has not bound the node yet, it is
+        // created with the default number of SOURCE slots.
+        node_shmem_ = bip::managed_shared_memory(
+                bip::open_or_create,
+                node_address_.c_str(),
+                Node::segmentSize(Node::DEFAULT_SLOTS));
+
+        // Facilitates synchronized access to shmem
+        node_ = Node::findOrConstruct(node_shmem_, Node::DEFAULT_SLOTS);
+    }
 
     // Let the node know this source is attached and retrieve *this's index
-    if (node_->acquireSlot(slot_index_) < 0) {
+    if (node_->acquireSlot(slot_index_, getpid()) < 0) {
         state_ = SourceState::ERR_NODEFULL;
         return;
     }
@@ -153,21 +186,17 @@ inline void SourceBase<T>::connect()
                                  "touch()ed a node.");
 
     // Wait for the SINK to bind and construct the shared object
-    if (node_->sink_state() != NodeState::SINK_BOUND) {
-        wait();
-
-        // Self post since all loops start with wait() and we just
-        // finished our wait(). This will make the first call to
-        // wait() a 'freebie'
-        node_->read_barrier(slot_index_).post();
-        did_wait_need_post_ = false;
-    }
+    waitForSink();
 
     // Find an existing shared object constructed by the SINK
-    obj_shmem_ =
-            bip::managed_shared_memory(bip::open_only, obj_address_.c_str());
-    std::pair<T *,std::size_t> temp = obj_shmem_.find<T>(typeid(T).name());
-    sh_object_ = temp.first;
+    if (local_) {
+        sh_object_ = local_->find<T>();
+    } else {
+        obj_shmem_ =
+                bip::managed_shared_memory(bip::open_only, obj_address_.c_str());
+        std::pair<T *,std::size_t> temp = obj_shmem_.find<T>(typeid(T).name());
+        sh_object_ = temp.first;
+    }
 
     // Only occurs when the name of the shared object does not match typeid(T).name()
     if (sh_object_ == nullptr) {
@@ -178,6 +207,22 @@ inline void SourceBase<T>::connect()
     state_ = SourceState::CONNECTED;
 }
 
+template <typename T>
+inline void SourceBase<T>::waitForSink()
+{
+    // A local SINK binds the node before it has allocated its frames
+    if (node_->sink_state() != NodeState::SINK_BOUND
+        || (local_ && local_->find<T>() == nullptr)) {
+
+        // Self post since all loops start with wait() and we just
+        // finished our wait(). This will make the first call to
+        // wait() a 'freebie'. Unless the stream ended while waiting.
+        if (wait() != NodeState::END)
+            node_->read_barrier(slot_index_).post();
+        did_wait_need_post_ = false;
+    }
+}
+
 template <typename T>
 inline NodeState SourceBase<T>::wait()
 {
@@ -189,23 +234,38 @@ inline NodeState SourceBase<T>::wait()
         throw std::runtime_error("wait() called when post() was required.");
 #endif
 
-    boost::system_time timeout = boost::get_system_time() + msec_t(10);
-
-    // Only wait if there is a SOURCE attached to the node
-    // Wait with timed wait with period check to prevent deadlocks
-    while (!node_->read_barrier(slot_index_).timed_wait(timeout)) {
-
-        // Loops checking if wait has been released
-        timeout = boost::get_system_time() + msec_t(10);
-
-        // If the sink has left the room, we should too
-        if (node_->sink_state() == NodeState::END)
-            break;
+    // Returns without a read if the sink has left the room, in which case
+    // the END state is broadcast to all waiting sources. A SINK that dies
+    // cannot do that for itself, so periodically check on it and broadcast
+    // END on its behalf. If the SINK left the stream open for another to
+    // resume, only SOURCES that will not wait for it end.
+    const uint64_t start = Counters::now();
+    while (node_->read_barrier(slot_index_).timed_wait(Node::HEARTBEAT_NS)
+           == Semaphore::Status::TIMEOUT) {
+
+        // The process hosting this SOURCE is shutting down
+        if (LocalNode::cancelled()) {
+            did_wait_need_post_ = true;
+            return NodeState::END;
+        }
+
+        if (!node_->sink_gone())
+            continue;
+
+        if (!node_->reconnectable()) {
+            node_->set_sink_state(NodeState::END);
+        } else if (!reconnectable_) {
+            did_wait_need_post_ = true;
+            return NodeState::END;
+        }
     }
+    node_->source_counters(slot_index_).recordWait(start);
 
     did_wait_need_post_ = true;
 
-    return node_->sink_state();
+    // Samples written before the SINK detached are read as usual
+    const NodeState state = node_->sink_state();
+    return state == NodeState::DETACHED ? NodeState::SINK_BOUND : state;
 }
 
 template <typename T>
@@ -221,6 +281,7 @@ inline void SourceBase<T>::post()
 
     if (node_->notifySourceReadComplete(slot_index_))
         node_->write_barrier.post();
+    node_->source_counters(slot_index_).recordPost();
 
     did_wait_need_post_ = false;
 }
@@ -235,6 +296,7 @@ class Source : public SourceBase<T> {
     using SourceBase<T>::sh_object_;
     using SourceBase<T>::connected_;
     using SourceBase<T>::state_;
+    using SourceBase<T>::read_slot;
 
 public:
     T *retrieve() const;
@@ -250,7 +312,7 @@ inline T *Source<T>::retrieve() const
         throw (std::runtime_error("Source must be connected before shared object is retrieved."));
 #endif
 
-    return sh_object_;
+    return sh_object_ + read_slot();
 }
 
 template <typename T>
@@ -262,7 +324,7 @@ inline T Source<T>::clone() const
         throw (std::runtime_error("Source must be connected before shared object is cloned."));
 #endif
 
-    return *sh_object_;
+    return *(sh_object_ + read_slot());
 }
 
 // 1. SharedFrameHeader
@@ -272,6 +334,7 @@ class Source<Frame> : public SourceBase<SharedFrameHeader> {
 public:
 
     using FrameParams = oat::FrameParams;
+    using ReadLease = oat::Lease<SourceBase<SharedFrameHeader>, const oat::Frame>;
 
     // TODO: This info is sitting inside SharedFrameHeader. Why am I creating a
     // new class here? This should be part of SharedFrameHeader so I can just
@@ -279,24 +342,44 @@ public:
     void connect() override;
     void connect(const oat::PixelColor col);
 
-    const oat::Frame * retrieve() const { return &frame_; }
-    oat::Frame clone() const { return frame_.clone(); }
-    void copyTo(oat::Frame &frame) const { frame_.copyTo(frame); };
+    const oat::Frame * retrieve() const { return &frames_[read_slot()]; }
+    oat::Frame clone() const { return frames_[read_slot()].clone(); }
+    void copyTo(oat::Frame &frame) const { frames_[read_slot()].copyTo(frame); };
     FrameParams parameters() const { return parameters_; }
 
+    /**
+     * @brief Wait for the SINK to write and lease the resulting frame. The
+     * lease is a read-only view directly into shared memory. Releasing it
+     * posts to the node, so it replaces the wait()/post() pair.
+     * @return Lease on the shared frame. Empty if the SINK has reached the
+     * END state.
+     */
+    ReadLease acquire();
+
 private :
 
-    // Shared frame
-    oat::Frame frame_;
+    // connect() to a local node, whose frames wrap the SINK's matrices
+    void waitForLocalFrames(void);
+
+    // Shared frames, one per ring slot
+    std::vector<oat::Frame> frames_;
     FrameParams parameters_;
 };
 
+inline Source<Frame>::ReadLease Source<Frame>::acquire()
+{
+    if (wait() == NodeState::END)
+        return ReadLease();
+
+    return ReadLease(this, frames_[read_slot()]);
+}
+
 inline void Source<Frame>::connect(const oat::PixelColor color)
 {
     connect();
 
     // Check frame pixel type if required
-    if (frame_.color() != color) {
+    if (frames_[0].color() != color) {
         throw std::runtime_error("Component requires frame source "
                                  "with pixels of type "
                                  + oat::color_str(color)
@@ -313,17 +396,13 @@ inline void Source<Frame>::connect()
 
     // Wait for the SINK to bind the node and provide matrix
     // header info.
-    if (node_->sink_state() != NodeState::SINK_BOUND) {
-
-        wait();
-
-        // Self post since all loops start with wait() and we just
-        // finished our wait(). This will make the first call to
-        // wait() a 'freebie'
-        node_->read_barrier(slot_index_).post();
-        did_wait_need_post_ = false;
+    if (local_) {
+        waitForLocalFrames();
+        return;
     }
 
+    waitForSink();
+
     // Find an existing shared object constructed by the SINK
     obj_shmem_ =
             bip::managed_shared_memory(bip::open_only, obj_address_.c_str());
@@ -337,24 +416,99 @@ inline void Source<Frame>::connect()
         throw std::runtime_error("Type mismatch: Source<T> can only connect to Node<T>.");
     }
 
-    // Generate frame header using info in shmem segment
+    // Map the segment the same way the SINK did. Pages were allocated by the
+    // SINK, so this only populates our page tables.
+    applySegmentOptions(obj_shmem_.get_address(),
+                        obj_shmem_.get_size(),
+                        sh_object_->segment_options(),
+                        false);
+
+    // Generate frame headers using info in shmem segment
     auto p = sh_object_->params();
-    frame_ = oat::Frame(p.rows,
-                        p.cols,
-                        p.type,
-                        p.color,
-                        obj_shmem_.get_address_from_handle(sh_object_->data()),
-                        obj_shmem_.get_address_from_handle(sh_object_->sample()));
+    auto data = static_cast<char *>(
+            obj_shmem_.get_address_from_handle(sh_object_->data()));
+    auto sample = static_cast<oat::Sample *>(
+            obj_shmem_.get_address_from_handle(sh_object_->sample()));
+    const size_t bytes = p.rows * p.cols * CV_ELEM_SIZE(p.type);
+
+    frames_.clear();
+    for (size_t i = 0; i < node_->depth(); i++) {
+        frames_.emplace_back(p.rows, p.cols, p.type, p.color,
+                             data + i * bytes,
+                             sample + i);
+    }
 
     // Save parameters to construct cv::Mats with
     parameters_.cols = p.cols;
     parameters_.rows = p.rows;
     parameters_.type = p.type;
     parameters_.color = p.color;
-    parameters_.bytes = frame_.total() * frame_.elemSize();
+    parameters_.bytes = bytes;
+
+    state_ = SourceState::CONNECTED;
+}
+
+inline void Source<Frame>::waitForLocalFrames()
+{
+    // The SINK binds the node before it allocates its frames
+    LocalFrames *local = local_->find<LocalFrames>();
+    if (node_->sink_state() != NodeState::SINK_BOUND || local == nullptr) {
+        if (wait() != NodeState::END)
+            node_->read_barrier(slot_index_).post();
+        did_wait_need_post_ = false;
+        local = local_->find<LocalFrames>();
+    }
+
+    // Only occurs if the stream ended before the SINK allocated its frames
+    // or the SINK is not a frame SINK
+    if (local == nullptr) {
+        state_ = SourceState::ERR_TYPEMIS;
+        throw std::runtime_error("Type mismatch: Source<T> can only connect to Node<T>.");
+    }
+
+    frames_.clear();
+    for (size_t i = 0; i < local->data.size(); i++)
+        frames_.emplace_back(local->data[i], local->color, &local->samples[i]);
+
+    const auto &m = local->data[0];
+    parameters_.cols = m.cols;
+    parameters_.rows = m.rows;
+    parameters_.type = m.type();
+    parameters_.color = local->color;
+    parameters_.bytes = m.total() * m.elemSize();
 
     state_ = SourceState::CONNECTED;
 }
 
+// 2. Arena backed, variable size tokens
+
+template <typename T>
+class Source<Arena<T>> : public SourceBase<Arena<T>> {
+
+    using SourceBase<Arena<T>>::sh_object_;
+    using SourceBase<Arena<T>>::state_;
+    using SourceBase<Arena<T>>::read_slot;
+
+public:
+
+    /**
+     * @brief Get the root object of the current sample. It, and everything
+     * it refers to, is read in place and is only valid until post().
+     */
+    const T *retrieve() const;
+};
+
+template <typename T>
+inline const T *Source<Arena<T>>::retrieve() const
+{
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if(state_ < SourceState::CONNECTED)
+        throw (std::runtime_error("Source must be connected before shared object is retrieved."));
+#endif
+
+    return &sh_object_[read_slot()].value();
+}
+
 }      /* namespace oat */
 #endif /* OAT_SOURCE_H */
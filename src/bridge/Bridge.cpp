@@ -0,0 +1,204 @@
+//******************************************************************************
+//* File:   Bridge.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "Bridge.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "../../lib/utility/TOMLSanitize.h"
+
+namespace oat {
+
+// Samples are sent as raw bytes
+static_assert(std::is_trivially_copyable<oat::Sample>::value,
+              "oat::Sample must be trivially copyable to be bridged.");
+
+constexpr uint32_t Bridge::WireHeader::MAGIC;
+constexpr uint32_t Bridge::WireHeader::END;
+
+Bridge::Bridge(const std::string &source_address,
+               const std::string &sink_address)
+: name_("bridge[" + source_address + "->" + sink_address + "]")
+, source_address_(source_address)
+, sink_address_(sink_address)
+, sending_(isEndpoint(sink_address))
+, endpoint_(sending_ ? sink_address : source_address)
+, socket_(context_, ZMQ_DEALER)
+{
+    if (isEndpoint(source_address) == isEndpoint(sink_address))
+        throw std::runtime_error("Exactly one of SOURCE and SINK must be a "
+                                 "ZMQ endpoint.");
+
+    // Give the last samples, including END, a chance to be delivered on exit
+    // without hanging if the remote bridge is gone
+    int linger = LINGER_MS;
+    socket_.setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+}
+
+void Bridge::appendOptions(po::options_description &opts)
+{
+    // Common program options
+    opts.add_options()
+        ("config,c", po::value<std::vector<std::string> >()->multitoken(),
+        "Configuration file/key pair.\n"
+        "e.g. 'config.toml mykey'")
+        ;
+
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("window,w", po::value<uint64_t>(),
+         "Sending bridge only. Maximum number of samples that can be in "
+         "flight before the receiving bridge has published them. Defaults "
+         "to 2.")
+        ;
+    opts.add(local_opts);
+
+    // Return valid keys
+    for (auto &o: local_opts.options())
+        config_keys_.push_back(o->long_name());
+}
+
+void Bridge::configure(const po::variables_map &vm)
+{
+    auto config_table = oat::config::getConfigTable(vm);
+    oat::config::checkKeys(config_keys_, config_table);
+
+    oat::config::getNumericValue<uint64_t>(
+        vm, config_table, "window", window_, 1);
+}
+
+void Bridge::connectToNode()
+{
+    if (sending_) {
+
+        // Wait for synchronous start with the local sink
+        connectSource();
+        socket_.bind(endpoint_);
+
+    } else {
+        socket_.connect(endpoint_);
+    }
+}
+
+bool Bridge::process()
+{
+    try {
+
+        return sending_ ? send() : receive();
+
+    } catch (const zmq::error_t &ex) {
+
+        // SIGINT during a blocking socket call is a normal exit
+        if (ex.num() == EINTR)
+            return true;
+
+        throw;
+    }
+}
+
+bool Bridge::send()
+{
+    WireHeader header;
+    zmq::message_t payload;
+    const bool end = readSample(header, payload);
+
+    // Respect the in-flight window
+    while (sent_ - acked_ >= window_)
+        receiveAcks(-1);
+
+    header.sequence = sent_++;
+    header.sent_ns = oat::Sample::monotonicNs();
+    if (end)
+        header.flags |= WireHeader::END;
+
+    socket_.send(&header, sizeof(header), ZMQ_SNDMORE);
+    socket_.send(payload);
+
+    // Opportunistically collect acknowledgements
+    receiveAcks(0);
+
+    return end;
+}
+
+bool Bridge::receive()
+{
+    zmq::message_t header_msg, payload;
+    socket_.recv(&header_msg);
+    received_ns_ = oat::Sample::monotonicNs();
+
+    int more = 0;
+    size_t more_size = sizeof(more);
+    socket_.getsockopt(ZMQ_RCVMORE, &more, &more_size);
+
+    WireHeader header;
+    if (!more || header_msg.size() != sizeof(header))
+        throw std::runtime_error("Malformed message received from "
+                                 + endpoint_ + ".");
+
+    std::memcpy(&header, header_msg.data(), sizeof(header));
+    if (header.magic != WireHeader::MAGIC)
+        throw std::runtime_error("Incompatible bridge at " + endpoint_ + ".");
+
+    socket_.recv(&payload);
+
+    if (header.flags & WireHeader::END)
+        return true;
+
+    if (!sink_bound_) {
+        bindSink(header);
+        sink_bound_ = true;
+    }
+
+    writeSample(header, payload);
+
+    // Acknowledge once published so that the sender feels backpressure
+    socket_.send(&header.sequence, sizeof(header.sequence));
+
+    return false;
+}
+
+void Bridge::receiveAcks(const long timeout_ms)
+{
+    zmq::pollitem_t item {static_cast<void *>(socket_), 0, ZMQ_POLLIN, 0};
+    long timeout = timeout_ms;
+
+    while (zmq::poll(&item, 1, timeout) > 0) {
+
+        uint64_t seq;
+        zmq::message_t ack;
+        socket_.recv(&ack);
+
+        // Acknowledgements arrive in order. Ignore any left over from an
+        // earlier session.
+        if (ack.size() == sizeof(seq)) {
+            std::memcpy(&seq, ack.data(), sizeof(seq));
+            if (seq < sent_ && seq >= acked_)
+                acked_ = seq + 1;
+        }
+
+        // Drain whatever else is ready without blocking
+        timeout = 0;
+    }
+}
+
+} /* namespace oat */
@@ -0,0 +1,197 @@
+//******************************************************************************
+//* File:   Bridge.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGE_H
+#define	OAT_BRIDGE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <zmq.hpp>
+
+#include "../../lib/datatypes/Sample.h"
+
+namespace oat {
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Abstract bridge. A bridge mirrors a node to a remote host. One of its
+ * addresses is a node address and the other is a ZMQ endpoint. When the
+ * SOURCE is a node, the bridge reads samples from it and sends them to the
+ * endpoint. When the SINK is a node, the bridge receives samples from the
+ * endpoint and publishes them to it. The sending bridge binds the endpoint;
+ * the receiving bridge connects to it.
+ *
+ * The receiving bridge acknowledges each sample once it has been published.
+ * The sender will not get more than a fixed window of samples ahead of these
+ * acknowledgements, so a slow remote pipeline applies backpressure to the
+ * local one just as a slow local component would.
+ */
+class Bridge {
+public:
+
+    /**
+     * @brief Abstract bridge.
+     * @param source_address SOURCE node address or ZMQ endpoint
+     * @param sink_address SINK node address or ZMQ endpoint
+     */
+    Bridge(const std::string &source_address,
+           const std::string &sink_address);
+    virtual ~Bridge() { }
+
+    /**
+     * @brief Append type-specific program options.
+     * @param opts Program option description to be specialized.
+     */
+    virtual void appendOptions(po::options_description &opts);
+
+    /**
+     * @brief Configure component parameters.
+     * @param vm Previously parsed program option value map.
+     */
+    virtual void configure(const po::variables_map &vm);
+
+    /**
+     * @brief Connect to the local node and the remote endpoint.
+     */
+    void connectToNode(void);
+
+    /**
+     * @brief Forward a single sample.
+     * @return End-of-stream signal. If true, this component should exit.
+     */
+    bool process(void);
+
+    /**
+     * @brief Get bridge name
+     * @return name
+     */
+    std::string name(void) const { return name_; }
+
+    /**
+     * @brief Check if an address is a ZMQ endpoint rather than a node.
+     */
+    static bool isEndpoint(const std::string &address)
+    {
+        return address.find("://") != std::string::npos;
+    }
+
+protected:
+
+    /**
+     * @brief Description of a sample that precedes its payload on the wire.
+     * Both hosts must share byte order and type sizes.
+     */
+    struct WireHeader {
+        static constexpr uint32_t MAGIC {0x0a7b0003};
+        static constexpr uint32_t END {1}; //!< Flag: SOURCE reached END
+
+        uint32_t magic {MAGIC};
+        uint32_t flags {0};
+        uint64_t sequence {0};
+        uint64_t sent_ns {0}; //!< Sender's monotonic clock when sent
+        oat::Sample sample;
+
+        // Frame geometry. Unused for other sample types.
+        int32_t rows {0};
+        int32_t cols {0};
+        int32_t type {0};
+        int32_t color {0};
+        int32_t codec {0};
+    };
+
+    // Component name
+    std::string name_;
+
+    // List of allowed configuration options
+    std::vector<std::string> config_keys_;
+
+    const std::string source_address_;
+    const std::string sink_address_;
+
+    /**
+     * @brief Move the latency stamps of a received sample from the sending
+     * host's monotonic clock to this one's. Time spent in transit is not
+     * counted.
+     */
+    void rebase(const WireHeader &header, oat::Sample &sample) const
+    {
+        sample.rebase(header.sent_ns, received_ns_);
+    }
+
+    /**
+     * @brief Touch and connect to the SOURCE node.
+     */
+    virtual void connectSource(void) = 0;
+
+    /**
+     * @brief Read the next sample from the SOURCE node.
+     * @param header Header to describe the sample in.
+     * @param payload Message to place the sample in.
+     * @return SOURCE end-of-stream signal.
+     */
+    virtual bool readSample(WireHeader &header, zmq::message_t &payload) = 0;
+
+    /**
+     * @brief Bind the SINK node. Called when the first sample arrives so that
+     * frames can be sized from it.
+     */
+    virtual void bindSink(const WireHeader &header) = 0;
+
+    /**
+     * @brief Publish a received sample to the SINK node.
+     */
+    virtual void writeSample(const WireHeader &header,
+                             const zmq::message_t &payload) = 0;
+
+private:
+
+    static constexpr int LINGER_MS {1000};
+
+    bool sending_;
+
+    // Remote endpoint
+    const std::string endpoint_;
+    zmq::context_t context_ {1};
+    zmq::socket_t socket_;
+
+    // Flow control
+    uint64_t window_ {2};
+    uint64_t sent_ {0};
+    uint64_t acked_ {0};
+    bool sink_bound_ {false};
+
+    // Monotonic time at which the sample being published was received
+    uint64_t received_ns_ {0};
+
+    bool send(void);
+    bool receive(void);
+
+    /**
+     * @brief Collect acknowledgements from the receiving bridge.
+     * @param timeout_ms Poll timeout, -1 to block until one arrives.
+     */
+    void receiveAcks(const long timeout_ms);
+};
+
+}      /* namespace oat */
+#endif /* OAT_BRIDGE_H */
@@ -0,0 +1,192 @@
+//******************************************************************************
+//* File:   FrameBridge.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "FrameBridge.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <opencv2/imgcodecs.hpp>
+
+#include "../../lib/shmemdf/SharedFrameHeader.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+namespace oat {
+
+FrameBridge::FrameBridge(const std::string &source_address,
+                         const std::string &sink_address)
+: Bridge(source_address, sink_address)
+{
+    // Nothing
+}
+
+void FrameBridge::appendOptions(po::options_description &opts)
+{
+    // Accepts common options
+    Bridge::appendOptions(opts);
+
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("codec,C", po::value<std::string>(),
+         "Sending bridge only. Frame encoding. Defaults to raw.\n"
+         "Values:\n"
+         "  raw: \tUncompressed pixels.\n"
+         "  jpeg: \tLossy JPEG compression.\n"
+         "  png: \tLossless PNG compression.")
+        ("quality,q", po::value<int>(),
+         "JPEG quality (0-100) or PNG compression level (0-9). Defaults to "
+         "95 and 1, respectively.")
+        ;
+    opts.add(local_opts);
+
+    // Return valid keys
+    for (auto &o: local_opts.options())
+        config_keys_.push_back(o->long_name());
+}
+
+void FrameBridge::configure(const po::variables_map &vm)
+{
+    Bridge::configure(vm);
+
+    auto config_table = oat::config::getConfigTable(vm);
+
+    // Codec
+    std::string codec;
+    if (oat::config::getValue<std::string>(vm, config_table, "codec", codec)) {
+        if (codec == "raw")
+            codec_ = RAW;
+        else if (codec == "jpeg")
+            codec_ = JPEG;
+        else if (codec == "png")
+            codec_ = PNG;
+        else
+            throw std::runtime_error("Unknown codec '" + codec + "'.");
+    }
+
+    // Quality
+    int quality;
+    if (codec_ == JPEG) {
+        quality = 95;
+        oat::config::getNumericValue<int>(
+            vm, config_table, "quality", quality, 0, 100);
+        encode_params_ = {cv::IMWRITE_JPEG_QUALITY, quality};
+    } else if (codec_ == PNG) {
+        quality = 1;
+        oat::config::getNumericValue<int>(
+            vm, config_table, "quality", quality, 0, 9);
+        encode_params_ = {cv::IMWRITE_PNG_COMPRESSION, quality};
+    }
+}
+
+void FrameBridge::connectSource()
+{
+    source_.touch(source_address_);
+    source_.connect();
+}
+
+bool FrameBridge::readSample(WireHeader &header, zmq::message_t &payload)
+{
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    auto frame = source_.acquire();
+    if (!frame)
+        return true;
+
+    header.sample = frame->sample();
+    header.rows = frame->rows;
+    header.cols = frame->cols;
+    header.type = frame->type();
+    header.color = frame->color();
+    header.codec = codec_;
+
+    if (codec_ == RAW) {
+
+        // Copied straight out of shared memory into the message
+        const size_t bytes = frame->total() * frame->elemSize();
+        payload.rebuild(bytes);
+        std::memcpy(payload.data(), frame->data, bytes);
+
+    } else {
+
+        // The encoded buffer is handed to ZMQ without a further copy
+        auto buf = new std::vector<uchar>;
+        cv::imencode(codec_ == JPEG ? ".jpg" : ".png", *frame, *buf,
+                     encode_params_);
+        payload.rebuild(buf->data(), buf->size(),
+                        [](void *, void *hint) {
+                            delete static_cast<std::vector<uchar> *>(hint);
+                        },
+                        buf);
+    }
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    return false;
+}
+
+void FrameBridge::bindSink(const WireHeader &header)
+{
+    cv::Mat temp(header.rows, header.cols, header.type);
+    sink_.bind(sink_address_, temp.total() * temp.elemSize());
+    sink_.retrieve(header.rows,
+                   header.cols,
+                   header.type,
+                   static_cast<oat::PixelColor>(header.color));
+}
+
+void FrameBridge::writeSample(const WireHeader &header,
+                              const zmq::message_t &payload)
+{
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    auto frame = sink_.acquire();
+    const size_t bytes = frame->total() * frame->elemSize();
+
+    if (header.codec == RAW) {
+
+        if (payload.size() != bytes)
+            throw std::runtime_error("Received frame has the wrong size.");
+
+        std::memcpy(frame->data, payload.data(), bytes);
+
+    } else {
+
+        // Decode directly into shared memory. imdecode() only reallocates if
+        // the decoded image does not match the shared frame.
+        cv::Mat dst = *frame;
+        const cv::Mat buf(1, payload.size(), CV_8UC1,
+                          const_cast<void *>(payload.data()));
+        cv::imdecode(buf, cv::IMREAD_UNCHANGED, &dst);
+
+        if (dst.data != frame->data)
+            throw std::runtime_error("Received frame has the wrong format.");
+    }
+
+    oat::Sample sample = header.sample;
+    rebase(header, sample);
+    frame->set_sample(sample);
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+}
+
+} /* namespace oat */
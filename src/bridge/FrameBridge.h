@@ -0,0 +1,67 @@
+//******************************************************************************
+//* File:   FrameBridge.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_FRAMEBRIDGE_H
+#define	OAT_FRAMEBRIDGE_H
+
+#include "Bridge.h"
+
+#include "../../lib/datatypes/Frame.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+namespace oat {
+
+/**
+ * @brief Bridge for frames. Frames can optionally be compressed before being
+ * sent.
+ */
+class FrameBridge : public Bridge {
+public:
+
+    FrameBridge(const std::string &source_address,
+                const std::string &sink_address);
+
+    void appendOptions(po::options_description &opts) override;
+    void configure(const po::variables_map &vm) override;
+
+private:
+
+    // Wire encodings
+    enum Codec : int32_t {
+        RAW = 0,
+        JPEG,
+        PNG
+    };
+
+    Codec codec_ {RAW};
+    std::vector<int> encode_params_;
+
+    oat::Source<oat::Frame> source_;
+    oat::Sink<oat::Frame> sink_;
+
+    void connectSource(void) override;
+    bool readSample(WireHeader &header, zmq::message_t &payload) override;
+    void bindSink(const WireHeader &header) override;
+    void writeSample(const WireHeader &header,
+                     const zmq::message_t &payload) override;
+};
+
+}      /* namespace oat */
+#endif /* OAT_FRAMEBRIDGE_H */
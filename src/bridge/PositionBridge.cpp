@@ -0,0 +1,92 @@
+//******************************************************************************
+//* File:   PositionBridge.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "PositionBridge.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace oat {
+
+PositionBridge::PositionBridge(const std::string &source_address,
+                               const std::string &sink_address)
+: Bridge(source_address, sink_address)
+{
+    // Nothing
+}
+
+void PositionBridge::connectSource()
+{
+    source_.touch(source_address_);
+    source_.connect();
+}
+
+bool PositionBridge::readSample(WireHeader &, zmq::message_t &payload)
+{
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    if (source_.wait() == oat::NodeState::END)
+        return true;
+
+    // Positions, including their sample information, are plain data and are
+    // sent exactly as they are laid out in shared memory
+    payload.rebuild(sizeof(oat::Position2D));
+    std::memcpy(payload.data(), source_.retrieve(), sizeof(oat::Position2D));
+
+    source_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    return false;
+}
+
+void PositionBridge::bindSink(const WireHeader &)
+{
+    sink_.bind(sink_address_, sink_address_);
+    shared_position_ = sink_.retrieve();
+}
+
+void PositionBridge::writeSample(const WireHeader &header,
+                                 const zmq::message_t &payload)
+{
+    if (payload.size() != sizeof(oat::Position2D))
+        throw std::runtime_error("Received position has the wrong size.");
+
+    // Copy to an aligned temporary. Assignment keeps this sink's label.
+    oat::Position2D pos(sink_address_);
+    std::memcpy(static_cast<void *>(&pos), payload.data(), sizeof(pos));
+
+    oat::Sample sample = pos.sample();
+    rebase(header, sample);
+    pos.set_sample(sample);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    sink_.wait();
+    *shared_position_ = pos;
+    sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+}
+
+} /* namespace oat */
@@ -0,0 +1,54 @@
+//******************************************************************************
+//* File:   PositionBridge.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_POSITIONBRIDGE_H
+#define	OAT_POSITIONBRIDGE_H
+
+#include "Bridge.h"
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+namespace oat {
+
+/**
+ * @brief Bridge for 2D positions.
+ */
+class PositionBridge : public Bridge {
+public:
+
+    PositionBridge(const std::string &source_address,
+                   const std::string &sink_address);
+
+private:
+
+    oat::Source<oat::Position2D> source_;
+    oat::Sink<oat::Position2D> sink_;
+    oat::Position2D * shared_position_ {nullptr};
+
+    void connectSource(void) override;
+    bool readSample(WireHeader &header, zmq::message_t &payload) override;
+    void bindSink(const WireHeader &header) override;
+    void writeSample(const WireHeader &header,
+                     const zmq::message_t &payload) override;
+};
+
+}      /* namespace oat */
+#endif /* OAT_POSITIONBRIDGE_H */
@@ -0,0 +1,166 @@
+//******************************************************************************
+//* File:   bridge_bench.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Loopback benchmark: frames are served to a local node, sent through a pair
+// of bridges over TCP on localhost, and read back from the mirrored node.
+// Reports throughput and end-to-end latency.
+//
+// Usage: bridge_bench [CODEC] [NUM_FRAMES] [ROWS] [COLS]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/shmemdf/SharedFrameHeader.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+#include "FrameBridge.h"
+
+namespace po = boost::program_options;
+using clk = std::chrono::steady_clock;
+
+const std::string in_addr = "bridge_bench_in";
+const std::string out_addr = "bridge_bench_out";
+const std::string endpoint = "tcp://127.0.0.1:5599";
+
+uint64_t usecNow()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            clk::now().time_since_epoch()).count();
+}
+
+void configure(oat::Bridge &bridge, const std::vector<std::string> &args)
+{
+    po::options_description opts;
+    bridge.appendOptions(opts);
+    po::variables_map vm;
+    po::store(po::command_line_parser(args).options(opts).run(), vm);
+    po::notify(vm);
+    bridge.configure(vm);
+}
+
+void runBridge(oat::Bridge *bridge)
+{
+    bridge->connectToNode();
+    while (!bridge->process()) { }
+}
+
+int main(int argc, char *argv[]) {
+
+    const std::string codec = argc > 1 ? argv[1] : "raw";
+    const uint64_t num_frames = argc > 2 ? std::stoull(argv[2]) : 500;
+    const int rows = argc > 3 ? std::stoi(argv[3]) : 1000;
+    const int cols = argc > 4 ? std::stoi(argv[4]) : 1000;
+
+    // Smooth test image with some texture so that compression is realistic
+    cv::Mat image(rows, cols, CV_8UC3);
+    for (int r = 0; r < rows; r++)
+        for (int c = 0; c < cols; c++)
+            image.at<cv::Vec3b>(r, c) = cv::Vec3b(r % 256, c % 256, (r + c) % 256);
+    cv::circle(image, cv::Point(cols / 2, rows / 2), rows / 4,
+               cv::Scalar(255, 255, 255), -1);
+
+    oat::FrameBridge sender(in_addr, endpoint);
+    oat::FrameBridge receiver(endpoint, out_addr);
+    configure(sender, {"--codec", codec});
+    configure(receiver, {});
+
+    std::thread send_thread(runBridge, &sender);
+    std::thread receive_thread(runBridge, &receiver);
+
+    // Frames are read back from the mirrored node
+    std::vector<double> latency_ms;
+    latency_ms.reserve(num_frames);
+    std::atomic<uint64_t> received {0};
+    std::thread read_thread([&latency_ms, &received] {
+        oat::Source<oat::Frame> source;
+        source.touch(out_addr);
+        source.connect();
+        while (true) {
+            auto frame = source.acquire();
+            if (!frame)
+                break;
+            const uint64_t sent = frame->sample().microseconds().count();
+            latency_ms.push_back((usecNow() - sent) / 1000.0);
+            ++received;
+        }
+    });
+
+    // Serve frames to the local node, time-stamped with the send time
+    std::chrono::duration<double> elapsed;
+    {
+        oat::Sink<oat::Frame> sink;
+        sink.bind(in_addr, image.total() * image.elemSize());
+        sink.retrieve(rows, cols, CV_8UC3, oat::PIX_BGR);
+
+        // Give the bridges a moment to connect so the first frames are not
+        // held in the socket queue
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        const auto start = clk::now();
+        for (uint64_t n = 0; n < num_frames; n++) {
+            auto frame = sink.acquire();
+            image.copyTo(*frame);
+            frame->incrementSampleCount(oat::Sample::Microseconds(usecNow()));
+        }
+
+        // Wait for the last frame to come back
+        while (received < num_frames
+               && clk::now() - start < std::chrono::seconds(10))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        elapsed = clk::now() - start;
+
+        // Sink goes out of scope and ENDs the pipeline
+    }
+
+    send_thread.join();
+    receive_thread.join();
+    read_thread.join();
+
+    if (latency_ms.empty()) {
+        std::cerr << "No frames were received.\n";
+        return -1;
+    }
+
+    std::sort(latency_ms.begin(), latency_ms.end());
+    auto pct = [&latency_ms](const double p) {
+        return latency_ms[std::min(latency_ms.size() - 1,
+                static_cast<size_t>(p * latency_ms.size()))];
+    };
+
+    const double mb = image.total() * image.elemSize() / 1e6;
+    std::cout << "Codec: " << codec
+              << ", frame: " << cols << "x" << rows
+              << ", received: " << latency_ms.size() << "/" << num_frames
+              << ", frames/s: " << latency_ms.size() / elapsed.count()
+              << ", MB/s: " << mb * latency_ms.size() / elapsed.count()
+              << ", latency p50/p99 (ms): " << pct(0.5) << "/" << pct(0.99)
+              << std::endl;
+
+    return 0;
+}
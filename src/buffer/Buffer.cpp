@@ -19,7 +19,12 @@
 
 #include "Buffer.h"
 
+#include <cctype>
+#include <cmath>
 #include <string>
+#include <unordered_map>
+
+#include "../../lib/utility/TOMLSanitize.h"
 
 namespace oat {
 
@@ -32,12 +37,200 @@ Buffer::Buffer(const std::string &source_address,
     // Nothing
 }
 
-Buffer::~Buffer()
+void Buffer::appendOptions(po::options_description &opts)
+{
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("config,c", po::value<std::vector<std::string> >()->multitoken(),
+        "Configuration file/key pair.\n"
+        "e.g. 'config.toml mykey'")
+        ("memory,m", po::value<std::string>(),
+         "Capacity of the in-memory FIFO. Either a size in bytes with an "
+         "optional K, M or G suffix (e.g. '512M'), or an amount of data in "
+         "seconds at the SOURCE sample rate (e.g. '30s'). Defaults to 1000 "
+         "tokens or 1G, whichever is smaller.")
+        ("pace",
+         "Publish tokens at the SOURCE sample rate instead of as fast as "
+         "downstream components read them. This smooths out the stream "
+         "after a stall.")
+        ("overflow,o", po::value<std::string>(),
+         "What to do with tokens that arrive when the in-memory FIFO is "
+         "full. Values:\n"
+         "  drop-newest: Discard the arriving token (default).\n"
+         "  drop-oldest: Discard the oldest buffered token.\n"
+         "  block: Hold the SOURCE until there is room.\n"
+         "  spill: Write the token to a ring file on disk. Tokens are "
+         "published in order once the memory FIFO drains.")
+        ("spill-dir", po::value<std::string>(),
+         "Directory in which to create the spill file. It should be on a "
+         "local disk rather than a RAM-backed file system. Defaults to "
+         "/var/tmp.")
+        ("spill-size", po::value<size_t>(),
+         "Size of the spill file in MB. Defaults to 1024.")
+        ;
+
+    opts.add(local_opts);
+
+    // Return valid keys
+    for (auto &o : local_opts.options())
+        config_keys_.push_back(o->long_name());
+}
+
+void Buffer::configure(const po::variables_map &vm)
+{
+    // Check for config file and entry correctness
+    auto config_table = oat::config::getConfigTable(vm);
+    oat::config::checkKeys(config_keys_, config_table);
+
+    // Memory capacity
+    std::string capacity;
+    if (oat::config::getValue(vm, config_table, "memory", capacity)) {
+
+        size_t end = 0;
+        double value = 0;
+        try {
+            value = std::stod(capacity, &end);
+        } catch (const std::logic_error &) {
+            end = 0;
+        }
+
+        std::string unit = capacity.substr(end);
+        for (auto &c : unit)
+            c = std::toupper(c);
+
+        const std::unordered_map<std::string, double> multipliers {
+            {"", 1}, {"B", 1},
+            {"K", 1 << 10}, {"KB", 1 << 10},
+            {"M", 1 << 20}, {"MB", 1 << 20},
+            {"G", 1 << 30}, {"GB", 1 << 30}
+        };
+
+        auto m = multipliers.find(unit);
+        if (end == 0 || value <= 0 || (unit != "S" && m == multipliers.end()))
+            throw std::runtime_error("Invalid memory capacity '" + capacity + "'.");
+
+        if (unit == "S")
+            capacity_sec_ = value;
+        else
+            capacity_bytes_ = static_cast<size_t>(value * m->second);
+    }
+
+    // Pacing
+    oat::config::getValue(vm, config_table, "pace", pace_);
+
+    // Overflow policy
+    std::string policy;
+    if (oat::config::getValue(vm, config_table, "overflow", policy)) {
+
+        const std::unordered_map<std::string, Overflow> policies {
+            {"drop-newest", Overflow::DROP_NEWEST},
+            {"drop-oldest", Overflow::DROP_OLDEST},
+            {"block", Overflow::BLOCK},
+            {"spill", Overflow::SPILL}
+        };
+
+        auto p = policies.find(policy);
+        if (p == policies.end())
+            throw std::runtime_error("Invalid overflow policy '" + policy + "'.");
+
+        overflow_ = p->second;
+    }
+
+    // Spill file
+    oat::config::getValue(vm, config_table, "spill-dir", spill_dir_);
+
+    size_t mb;
+    if (oat::config::getNumericValue<size_t>(
+            vm, config_table, "spill-size", mb, 1))
+        spill_bytes_ = mb << 20;
+}
+
+void Buffer::openSpill(const size_t record_bytes)
+{
+    if (overflow_ == Overflow::SPILL)
+        spill_.reset(new SpillRing(spill_dir_, record_bytes, spill_bytes_));
+}
+
+void Buffer::setCapacity(const size_t token_bytes, const double period_sec)
 {
-    // Join threads
+    period_sec_ = period_sec;
+
+    if (capacity_bytes_ > 0) {
+        memory_capacity_ = capacity_bytes_ / token_bytes;
+    } else if (capacity_sec_ > 0) {
+        if (period_sec <= 0)
+            throw std::runtime_error("The SOURCE sample rate is unknown. "
+                                     "Specify buffer memory in bytes.");
+        memory_capacity_
+            = static_cast<size_t>(std::ceil(capacity_sec_ / period_sec));
+    } else {
+        memory_capacity_ = DEFAULT_BYTES / token_bytes;
+        if (memory_capacity_ > DEFAULT_TOKENS)
+            memory_capacity_ = DEFAULT_TOKENS;
+    }
+
+    // Need at least two so that one can be published while another fills
+    if (memory_capacity_ < 2)
+        memory_capacity_ = 2;
+}
+
+void Buffer::notifyData()
+{
+    // Taking the lock orders this with the consumer's check of fill() so that
+    // the notification cannot fall between the check and the wait
+    { std::lock_guard<std::mutex> lk(cv_m_); }
+    cv_.notify_one();
+}
+
+bool Buffer::waitForData()
+{
+    std::unique_lock<std::mutex> lk(cv_m_);
+    cv_.wait(lk, [this] { return !sink_running_ || fill() > 0; });
+
+    return sink_running_;
+}
+
+void Buffer::notifySpace()
+{
+    { std::lock_guard<std::mutex> lk(space_m_); }
+    space_cv_.notify_one();
+}
+
+void Buffer::pace()
+{
+    if (!pace_ || period_sec_ <= 0)
+        return;
+
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(period_sec_));
+    const auto now = Clock::now();
+
+    // After a stall, restart the schedule instead of bursting to catch up
+    if (next_publish_ + period < now)
+        next_publish_ = now;
+    else
+        std::this_thread::sleep_until(next_publish_);
+
+    next_publish_ += period;
+}
+
+void Buffer::stopConsumer()
+{
+    // Wake and join threads
     sink_running_ = false;
+    { std::lock_guard<std::mutex> lk(cv_m_); }
+    cv_.notify_all();
+    { std::lock_guard<std::mutex> lk(space_m_); }
+    space_cv_.notify_all();
     if (sink_thread_.joinable())
         sink_thread_.join();
 }
 
+Buffer::~Buffer()
+{
+    // Nothing left to do if the derived class stopped the consumer, as it
+    // must
+    stopConsumer();
+}
+
 } /* namespace oat */
@@ -20,19 +20,37 @@
 #ifndef OAT_BUFFER_H
 #define OAT_BUFFER_H
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <boost/lockfree/spsc_queue.hpp>
+#include <boost/program_options.hpp>
 
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
 
+#include "SpillRing.h"
+
 namespace oat {
 
+namespace po = boost::program_options;
+
+/**
+ * What to do with a sample that arrives when the in-memory FIFO is full.
+ */
+enum class Overflow {
+    DROP_NEWEST, //!< Discard the arriving sample
+    DROP_OLDEST, //!< Discard the oldest buffered sample to make room
+    BLOCK,       //!< Hold the SOURCE until there is room
+    SPILL        //!< Write the sample to a ring file on disk
+};
+
 /**
  * Abstract Buffer.
  */
@@ -49,6 +67,18 @@ public:
 
     virtual ~Buffer();
 
+    /**
+     * @brief Append program options.
+     * @param opts Program option description to be specialized.
+     */
+    virtual void appendOptions(po::options_description &opts);
+
+    /**
+     * @brief Configure component parameters.
+     * @param vm Previously parsed program option value map.
+     */
+    virtual void configure(const po::variables_map &vm);
+
     /**
      * @brief Connect to shared memory NODES.
      */
@@ -65,16 +95,123 @@ public:
      */
     std::string name(void) const { return name_; }
 
+    /**
+     * @brief Number of tokens held in memory.
+     */
+    virtual size_t memoryFill(void) const = 0;
+
+    /**
+     * @brief Number of tokens held in the spill file on disk.
+     */
+    size_t diskFill(void) const { return spill_ ? spill_->size() : 0; }
+
+    /**
+     * @brief Total number of tokens waiting to be published.
+     */
+    size_t fill(void) const { return memoryFill() + diskFill(); }
+
+    /**
+     * @brief Number of tokens that have been written to disk.
+     */
+    uint64_t spilled(void) const { return spilled_; }
+
+    /**
+     * @brief Number of tokens that have been discarded due to overflow.
+     */
+    uint64_t dropped(void) const { return dropped_; }
+
 protected:
-    static constexpr size_t BUFFSIZE{1000};
-    using buffer_size_t = boost::lockfree::capacity<BUFFSIZE>;
+    using Clock = std::chrono::steady_clock;
     using msec = std::chrono::milliseconds;
 
+    // FIFO capacity when none is specified: this many tokens or bytes,
+    // whichever is reached first
+    static constexpr size_t DEFAULT_TOKENS {1000};
+    static constexpr size_t DEFAULT_BYTES {1ul << 30};
+
     /**
      * @brief In response to downstream request, publish object from FIFO to SINK.
      */
     virtual void pop(void) = 0;
 
+    /**
+     * @brief Create the spill file if the overflow policy calls for one.
+     * Called by derived classes once the size of a token is known.
+     * @param record_bytes Bytes required to store one token on disk
+     */
+    void openSpill(const size_t record_bytes);
+
+    /**
+     * @brief Resolve the configured FIFO capacity to a number of tokens and
+     * store it in memory_capacity_. Called by derived classes once the size
+     * of a token and the SOURCE sample rate are known.
+     * @param token_bytes Bytes required to store one token in memory
+     * @param period_sec SOURCE sample period. 0 if unknown.
+     */
+    void setCapacity(const size_t token_bytes, const double period_sec);
+
+    /**
+     * @brief Called by the producer each time it adds a token.
+     */
+    void notifyData(void);
+
+    /**
+     * @brief Consumer: block until there are tokens to publish.
+     * @return False if the buffer is shutting down.
+     */
+    bool waitForData(void);
+
+    /**
+     * @brief Consumer: if pacing is enabled, sleep until the next token is
+     * due according to the SOURCE sample rate.
+     */
+    void pace(void);
+
+    /**
+     * @brief Block until has_space() is true or the buffer is shutting down.
+     * @return True if there is space.
+     */
+    template <typename Pred>
+    bool waitForSpace(Pred has_space);
+
+    /**
+     * @brief Called by the consumer each time it frees space in the FIFO.
+     */
+    void notifySpace(void);
+
+    /**
+     * @brief Wake and join the consumer thread. Derived classes must call
+     * this in their destructors, before the SINK and FIFO that the consumer
+     * uses are destroyed.
+     */
+    void stopConsumer(void);
+
+    // List of allowed configuration options
+    std::vector<std::string> config_keys_;
+
+    // FIFO capacity as configured (at most one of these is non-zero) and
+    // as resolved to tokens by setCapacity()
+    size_t capacity_bytes_ {0};
+    double capacity_sec_ {0.0};
+    size_t memory_capacity_ {0};
+
+    // Publish at the SOURCE sample rate
+    bool pace_ {false};
+    double period_sec_ {0.0};
+    Clock::time_point next_publish_;
+
+    // Overflow handling
+    Overflow overflow_ {Overflow::DROP_NEWEST};
+    std::string spill_dir_ {"/var/tmp"};
+    size_t spill_bytes_ {1ul << 30};
+    std::unique_ptr<SpillRing> spill_;
+    std::atomic<uint64_t> spilled_ {0};
+    std::atomic<uint64_t> dropped_ {0};
+
+    // Serializes FIFO reads between the consumer and a producer dropping
+    // the oldest token
+    std::mutex consume_m_;
+
     // Buffer name.
     const std::string name_;
 
@@ -84,11 +221,24 @@ protected:
     // Sink
     std::atomic<bool> sink_running_{true};
     std::thread sink_thread_;
+    const std::string sink_address_;
+
+private:
     std::mutex cv_m_;
     std::condition_variable cv_;
-    const std::string sink_address_;
+    std::mutex space_m_;
+    std::condition_variable space_cv_;
 };
 
+template <typename Pred>
+bool Buffer::waitForSpace(Pred has_space)
+{
+    std::unique_lock<std::mutex> lk(space_m_);
+    space_cv_.wait(lk, [&] { return !sink_running_ || has_space(); });
+
+    return sink_running_;
+}
+
 #ifndef NDEBUG
 
 static constexpr size_t PROGRESS_BAR_WIDTH{80};
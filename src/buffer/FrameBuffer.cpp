@@ -30,6 +30,12 @@ FrameBuffer::FrameBuffer(const std::string &source_address,
     // Nothing
 }
 
+FrameBuffer::~FrameBuffer()
+{
+    // The consumer uses the slabs, queues and sink below
+    stopConsumer();
+}
+
 void FrameBuffer::connectToNode()
 {
     // Establish our a slot in the node
@@ -40,6 +46,21 @@ void FrameBuffer::connectToNode()
 
     // Get frame meta data to format sink
     auto param = source_.parameters();
+    param_ = param;
+
+    // Allocate one slab per token of FIFO capacity
+    setCapacity(param.bytes, source_.retrieve()->sample_period_sec());
+    slabs_.reset(new oat::Frame[memory_capacity_]);
+    free_.reset(new SPSCBuffer(memory_capacity_));
+    buffer_.reset(new SPSCBuffer(memory_capacity_));
+    for (size_t i = 0; i < memory_capacity_; i++) {
+        slabs_[i].create(param.rows, param.cols, param.type);
+        slabs_[i].set_color(param.color);
+        free_->push(i);
+    }
+
+    // Overflow to disk, if requested
+    openSpill(SPILL_HEADER_BYTES + param.bytes);
 
     // Bind sink node
     sink_.bind(sink_address_, param.bytes);
@@ -59,8 +80,16 @@ bool FrameBuffer::push()
     if (source_.wait() == oat::NodeState::END)
         return true;
 
-    if (!buffer_.push(source_.clone()))
-        std::cerr << "Buffer overrun.\n";
+    // Copy into a free slab. If there are none, the FIFO is full. Once
+    // frames have spilled to disk, keep spilling until the consumer has
+    // drained the file so that frames stay in order.
+    size_t slab;
+    if ((!spill_ || spill_->empty()) && free_->pop(slab)) {
+        source_.copyTo(slabs_[slab]);
+        buffer_->push(slab);
+    } else {
+        overflow();
+    }
 
     // Tell sink it can continue
     source_.post();
@@ -69,28 +98,94 @@ bool FrameBuffer::push()
     //  END CRITICAL SECTION  //
 
     // Notify comsumer thread that it can proceed
-    cv_.notify_one();
+    notifyData();
 
 #ifndef NDEBUG
-    showBufferState(buffer_, BUFFSIZE);
+    showBufferState(*buffer_, memory_capacity_);
 #endif
 
     // Sink was not at END state
     return false;
 }
 
-void FrameBuffer::pop()
+void FrameBuffer::overflow()
 {
-    while (sink_running_) {
+    size_t slab;
+
+    switch (overflow_) {
+
+        case Overflow::DROP_OLDEST:
+        {
+            // Take a slab back from the FIFO unless the consumer has just
+            // freed one
+            {
+                std::lock_guard<std::mutex> lk(consume_m_);
+                if (!free_->pop(slab)) {
+                    buffer_->pop(slab);
+                    dropped_++;
+                }
+            }
+
+            source_.copyTo(slabs_[slab]);
+            buffer_->push(slab);
+            break;
+        }
+        case Overflow::BLOCK:
+        {
+            if (!waitForSpace([this] { return free_->read_available() > 0; }))
+                break;
+
+            free_->pop(slab);
+            source_.copyTo(slabs_[slab]);
+            buffer_->push(slab);
+            break;
+        }
+        case Overflow::SPILL:
+        {
+            char *record = spill_->writeSlot();
+            if (record) {
+                auto frame = spillFrame(record);
+                source_.copyTo(frame);
+                spill_->commitWrite();
+                spilled_++;
+                break;
+            }
+
+            // Spill file is full as well
+            dropped_++;
+            std::cerr << "Buffer overrun.\n";
+            break;
+        }
+        case Overflow::DROP_NEWEST:
+        {
+            dropped_++;
+            std::cerr << "Buffer overrun.\n";
+            break;
+        }
+    }
+}
 
-        // Proceed only if buffer_ has data
-        std::unique_lock<std::mutex> lk(cv_m_);
-        if  (cv_.wait_for(lk, msec(10)) == std::cv_status::timeout)
-            continue;
+oat::Frame FrameBuffer::spillFrame(char *record) const
+{
+    return oat::Frame(static_cast<int>(param_.rows),
+                      static_cast<int>(param_.cols),
+                      param_.type,
+                      param_.color,
+                      record + SPILL_HEADER_BYTES,
+                      record);
+}
+
+void FrameBuffer::pop()
+{
+    // Proceed only if there is data
+    while (waitForData()) {
 
         // Publish objects when they are requested until the buffer
         // is empty
-        while (buffer_.read_available() > 0) {
+        while (fill() > 0) {
+
+            // Hold back until the next frame is due, if pacing
+            pace();
 
             // START CRITICAL SECTION //
             ////////////////////////////
@@ -98,10 +193,24 @@ void FrameBuffer::pop()
             // Wait for sources to read
             sink_.wait();
 
-            // TODO: use specialized spsc allocator for popping somehow?
-            buffer_.consume_one(
-                [this](oat::Frame frame){ frame.copyTo(shared_frame_); }
-            );
+            // Publish the oldest frame. Frames in memory are always older
+            // than those on disk.
+            {
+                std::lock_guard<std::mutex> clk(consume_m_);
+
+                size_t slab;
+                if (buffer_->pop(slab)) {
+                    slabs_[slab].copyTo(shared_frame_);
+                    free_->push(slab);
+                } else if (spill_ && !spill_->empty()) {
+                    auto frame
+                        = spillFrame(const_cast<char *>(spill_->readSlot()));
+                    frame.copyTo(shared_frame_);
+                    spill_->commitRead();
+                }
+            }
+
+            notifySpace();
 
             // Tell sources there is new data
             sink_.post();
@@ -22,6 +22,8 @@
 
 #include "Buffer.h"
 
+#include <memory>
+
 #include <boost/lockfree/spsc_queue.hpp>
 
 #include "../../lib/shmemdf/SharedFrameHeader.h"
@@ -30,8 +32,8 @@ namespace oat {
 
 class FrameBuffer : public Buffer {
 
-    using SPSCBuffer =
-        boost::lockfree::spsc_queue<oat::Frame, buffer_size_t>;
+    // Queues carry indices into the slab pool rather than frames
+    using SPSCBuffer = boost::lockfree::spsc_queue<size_t>;
 
 public:
 
@@ -43,19 +45,40 @@ public:
     FrameBuffer(const std::string &source_address,
                 const std::string &sink_address);
 
+    ~FrameBuffer();
 
     void connectToNode(void) override;
     bool push(void) override;
+    size_t memoryFill(void) const override
+    {
+        return buffer_ ? buffer_->read_available() : 0;
+    }
 
 private:
 
+    // Bytes reserved for the sample at the start of each spill record
+    static constexpr size_t SPILL_HEADER_BYTES
+        {(sizeof(oat::Sample) + 63) / 64 * 64};
+
     void pop(void) override;
 
+    // Handle a frame that arrives when there is no free slab
+    void overflow(void);
+
+    // Frame wrapping a spill file record
+    oat::Frame spillFrame(char *record) const;
+
     // Source
     oat::Source<oat::Frame> source_;
+    oat::FrameParams param_;
+
+    // Slab pool, allocated once when the source format is known. Slabs
+    // circulate from free_ to buffer_ (push) and back again (pop).
+    std::unique_ptr<oat::Frame[]> slabs_;
+    std::unique_ptr<SPSCBuffer> free_;
 
     // Buffer
-    SPSCBuffer buffer_;
+    std::unique_ptr<SPSCBuffer> buffer_;
 
     // Sink
     oat::Frame shared_frame_;
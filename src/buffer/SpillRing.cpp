@@ -0,0 +1,97 @@
+//******************************************************************************
+//* File:   SpillRing.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "SpillRing.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace oat {
+
+SpillRing::SpillRing(const std::string &dir,
+                     const size_t record_bytes,
+                     const size_t capacity_bytes)
+: stride_((record_bytes + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN)
+{
+    capacity_ = stride_ > 0 ? capacity_bytes / stride_ : 0;
+    if (capacity_ == 0)
+        throw std::runtime_error("Spill file is too small to hold a sample.");
+
+    map_bytes_ = capacity_ * stride_;
+
+    std::string path = dir + "/oat-buffer-XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+
+    fd_ = mkstemp(name.data());
+    if (fd_ < 0)
+        throw std::runtime_error("Could not create spill file in '" + dir
+                                 + "': " + std::strerror(errno));
+
+    // Remove the name right away so that the file goes when we do
+    unlink(name.data());
+
+    // Reserve the blocks now rather than failing mid-stream
+    const int rc = posix_fallocate(fd_, 0, map_bytes_);
+    if (rc != 0) {
+        close(fd_);
+        throw std::runtime_error("Could not allocate spill file: "
+                                 + std::string(std::strerror(rc)));
+    }
+
+    void *p = mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        close(fd_);
+        throw std::runtime_error("Could not map spill file: "
+                                 + std::string(std::strerror(errno)));
+    }
+
+    data_ = static_cast<char *>(p);
+}
+
+SpillRing::~SpillRing()
+{
+    munmap(data_, map_bytes_);
+    close(fd_);
+}
+
+char *SpillRing::writeSlot()
+{
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == capacity_)
+        return nullptr;
+
+    return data_ + (head % capacity_) * stride_;
+}
+
+const char *SpillRing::readSlot() const
+{
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == tail)
+        return nullptr;
+
+    return data_ + (tail % capacity_) * stride_;
+}
+
+} /* namespace oat */
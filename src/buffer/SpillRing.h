@@ -0,0 +1,106 @@
+//******************************************************************************
+//* File:   SpillRing.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SPILL_RING_H
+#define	OAT_SPILL_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace oat {
+
+/**
+ * Fixed-size record ring held in a memory-mapped file on local disk. Used by
+ * buffers to hold samples that do not fit in memory. A single producer
+ * thread writes records and a single consumer thread reads them back in the
+ * order they were written.
+ */
+class SpillRing {
+
+public:
+
+    /**
+     * @brief Create an anonymous spill file in the given directory. The file
+     * is unlinked as soon as it is mapped, so it never outlives the process.
+     * @param dir Directory in which to create the file
+     * @param record_bytes Size of each record
+     * @param capacity_bytes Size of the file. Determines the number of
+     * records that can be held.
+     */
+    SpillRing(const std::string &dir,
+              const size_t record_bytes,
+              const size_t capacity_bytes);
+    ~SpillRing();
+
+    SpillRing(const SpillRing &) = delete;
+    SpillRing &operator=(const SpillRing &) = delete;
+
+    // Number of records that the ring can hold
+    size_t capacity(void) const { return capacity_; }
+
+    // Number of records currently held
+    size_t size(void) const
+    {
+        return head_.load(std::memory_order_acquire)
+               - tail_.load(std::memory_order_acquire);
+    }
+
+    bool empty(void) const { return size() == 0; }
+
+    /**
+     * @brief Producer: get the next record to write.
+     * @return Pointer to record or nullptr if the ring is full.
+     */
+    char *writeSlot(void);
+
+    /**
+     * @brief Producer: publish the record obtained from writeSlot().
+     */
+    void commitWrite(void) { head_.fetch_add(1, std::memory_order_release); }
+
+    /**
+     * @brief Consumer: get the oldest record.
+     * @return Pointer to record or nullptr if the ring is empty.
+     */
+    const char *readSlot(void) const;
+
+    /**
+     * @brief Consumer: release the record obtained from readSlot().
+     */
+    void commitRead(void) { tail_.fetch_add(1, std::memory_order_release); }
+
+private:
+
+    // Records are padded to a multiple of this
+    static constexpr size_t RECORD_ALIGN {64};
+
+    int fd_ {-1};
+    char *data_ {nullptr};
+    size_t map_bytes_ {0};
+    size_t stride_ {0};
+    size_t capacity_ {0};
+
+    // Monotonic write and read counts
+    std::atomic<size_t> head_ {0};
+    std::atomic<size_t> tail_ {0};
+};
+
+}      /* namespace oat */
+#endif /* OAT_SPILL_RING_H */
@@ -19,6 +19,7 @@
 //******************************************************************************
 
 #include <iostream>
+#include <new>
 
 #include "TokenBuffer.h"
 
@@ -32,6 +33,13 @@ TokenBuffer<T>::TokenBuffer(const std::string &source_address,
     // Nothing
 }
 
+template <typename T>
+TokenBuffer<T>::~TokenBuffer()
+{
+    // The consumer uses the token pool, queues and sink below
+    stopConsumer();
+}
+
 template <typename T>
 void TokenBuffer<T>::connectToNode()
 {
@@ -45,6 +53,17 @@ void TokenBuffer<T>::connectToNode()
     sink_.bind(sink_address_, sink_address_);
     shared_token_ = sink_.retrieve();
 
+    // Allocate the token pool
+    setCapacity(sizeof(T), source_.retrieve()->sample_period_sec());
+    slots_.assign(memory_capacity_, *shared_token_);
+    free_.reset(new SPSCBuffer(memory_capacity_));
+    buffer_.reset(new SPSCBuffer(memory_capacity_));
+    for (size_t i = 0; i < memory_capacity_; i++)
+        free_->push(i);
+
+    // Overflow to disk, if requested
+    openSpill(sizeof(T));
+
     // Start consumer thread
     sink_thread_ = std::thread(&TokenBuffer<T>::pop, this);
 }
@@ -60,8 +79,13 @@ bool TokenBuffer<T>::push()
     if (source_.wait() == oat::NodeState::END)
         return true;
 
-    if (!buffer_.push(source_.clone()))
-        std::cerr << "Buffer overrun.\n";
+    // Once tokens have spilled to disk, keep spilling until the consumer has
+    // drained the file so that tokens stay in order
+    size_t slot;
+    if ((!spill_ || spill_->empty()) && free_->pop(slot))
+        store(slot);
+    else
+        overflow();
 
     // Tell sink it can continue
     source_.post();
@@ -70,10 +94,10 @@ bool TokenBuffer<T>::push()
     //  END CRITICAL SECTION  //
 
     // Notify comsumer thread that it can proceed
-    cv_.notify_one();
+    notifyData();
 
 #ifndef NDEBUG
-    showBufferState(buffer_, BUFFSIZE);
+    showBufferState(*buffer_, memory_capacity_);
 #endif
 
     // Sink was not at END state
@@ -81,19 +105,80 @@ bool TokenBuffer<T>::push()
 }
 
 template <typename T>
-void TokenBuffer<T>::pop()
+void TokenBuffer<T>::store(const size_t slot)
 {
+    slots_[slot] = *source_.retrieve();
+    buffer_->push(slot);
+}
 
-    while (sink_running_) {
+template <typename T>
+void TokenBuffer<T>::overflow()
+{
+    size_t slot;
+
+    switch (overflow_) {
+
+        case Overflow::DROP_OLDEST:
+        {
+            // Take a slot back from the FIFO unless the consumer has just
+            // freed one
+            {
+                std::lock_guard<std::mutex> lk(consume_m_);
+                if (!free_->pop(slot)) {
+                    buffer_->pop(slot);
+                    dropped_++;
+                }
+            }
+
+            store(slot);
+            break;
+        }
+        case Overflow::BLOCK:
+        {
+            if (!waitForSpace([this] { return free_->read_available() > 0; }))
+                break;
+
+            free_->pop(slot);
+            store(slot);
+            break;
+        }
+        case Overflow::SPILL:
+        {
+            char *record = spill_->writeSlot();
+            if (record) {
+                new (record) T(source_.clone());
+                spill_->commitWrite();
+                spilled_++;
+                break;
+            }
+
+            // Spill file is full as well
+            dropped_++;
+            std::cerr << "Buffer overrun.\n";
+            break;
+        }
+        case Overflow::DROP_NEWEST:
+        {
+            dropped_++;
+            std::cerr << "Buffer overrun.\n";
+            break;
+        }
+    }
+}
 
-        // Proceed only if buffer_ has data
-        std::unique_lock<std::mutex> lk(cv_m_);
-        if  (cv_.wait_for(lk, msec(10)) == std::cv_status::timeout)
-            continue;
+template <typename T>
+void TokenBuffer<T>::pop()
+{
+
+    // Proceed only if there is data
+    while (waitForData()) {
 
         // Publish objects when they are requested until the buffer
         // is empty
-        while (buffer_.read_available() > 0) {
+        while (fill() > 0) {
+
+            // Hold back until the next token is due, if pacing
+            pace();
 
             // START CRITICAL SECTION //
             ////////////////////////////
@@ -101,7 +186,23 @@ void TokenBuffer<T>::pop()
             // Wait for sources to read
             sink_.wait();
 
-            buffer_.pop(*shared_token_);
+            // Publish the oldest token. Tokens in memory are always older
+            // than those on disk.
+            {
+                std::lock_guard<std::mutex> clk(consume_m_);
+
+                size_t slot;
+                if (buffer_->pop(slot)) {
+                    *shared_token_ = slots_[slot];
+                    free_->push(slot);
+                } else if (spill_ && !spill_->empty()) {
+                    *shared_token_
+                        = *reinterpret_cast<const T *>(spill_->readSlot());
+                    spill_->commitRead();
+                }
+            }
+
+            notifySpace();
 
             // Tell sources there is new data
             sink_.post();
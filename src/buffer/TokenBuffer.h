@@ -22,6 +22,9 @@
 
 #include "Buffer.h"
 
+#include <memory>
+#include <vector>
+
 #include <boost/lockfree/spsc_queue.hpp>
 
 #include "../../lib/datatypes/Position2D.h"
@@ -34,26 +37,43 @@ namespace oat {
 template <typename T>
 class TokenBuffer : public Buffer {
 
-    using SPSCBuffer =
-        boost::lockfree::spsc_queue<T, buffer_size_t>;
+    // Queues carry indices into the token pool rather than tokens
+    using SPSCBuffer = boost::lockfree::spsc_queue<size_t>;
 
 public:
 
     TokenBuffer(const std::string &source_address,
                 const std::string &sink_address);
 
+    ~TokenBuffer();
+
     void connectToNode(void) override;
     bool push(void) override;
+    size_t memoryFill(void) const override
+    {
+        return buffer_ ? buffer_->read_available() : 0;
+    }
 
 private:
 
     void pop(void) override;
 
+    // Handle a token that arrives when the FIFO is full
+    void overflow(void);
+
+    // Store the current SOURCE token in a pool slot and queue it
+    void store(const size_t slot);
+
     // Source
     oat::Source<T> source_;
 
+    // Token pool, allocated once the source sample rate is known. Slots
+    // circulate from free_ to buffer_ (push) and back again (pop).
+    std::vector<T> slots_;
+    std::unique_ptr<SPSCBuffer> free_;
+
     // Buffer
-    SPSCBuffer buffer_;
+    std::unique_ptr<SPSCBuffer> buffer_;
 
     // Sink
     T * shared_token_;
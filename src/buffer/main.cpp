@@ -29,6 +29,7 @@
 #include <opencv2/core.hpp>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ProgramOptions.h"
 
@@ -116,6 +117,7 @@ int main(int argc, char *argv[])
 {
 
     std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
 
     // Results of command line input
     std::string type;
@@ -201,6 +203,12 @@ int main(int argc, char *argv[])
                     return -1;
                 }
             }
+
+            // Specialize program options for the selected TYPE
+            po::options_description detail_opts {"CONFIGURATION"};
+            buffer->appendOptions(detail_opts);
+            visible_options.add(detail_opts);
+            options.add(detail_opts);
         }
 
         // Check INFO arguments
@@ -252,6 +260,8 @@ int main(int argc, char *argv[])
                  .run(), option_map);
         po::notify(option_map);
 
+        buffer->configure(option_map);
+
         // Tell user
         std::cout << oat::whoMessage(buffer->name(),
                 "Listening to source " + oat::sourceText(source) + ".\n")
@@ -264,6 +274,11 @@ int main(int argc, char *argv[])
         run(buffer);
 
         // Tell user
+        if (buffer->spilled() > 0 || buffer->dropped() > 0)
+            std::cout << oat::whoMessage(comp_name,
+                    std::to_string(buffer->spilled()) + " tokens spilled to disk, "
+                    + std::to_string(buffer->dropped()) + " dropped.\n");
+
         std::cout << oat::whoMessage(comp_name, "Exiting.")
                   << std::endl;
 
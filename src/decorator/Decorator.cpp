@@ -173,19 +173,11 @@ bool Decorator::process()
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sink to write to node
-    if (frame_source_.wait() == oat::NodeState::END)
+    // Wait for sink to write to node and lease the shared frame
+    auto frame = frame_source_.acquire();
+    if (!frame)
         return true;
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame_);
-
-    // Tell sink it can continue
-    frame_source_.post();
-
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
-
     // 2. Get positions
     for (pvec_size_t i = 0; i !=  position_sources_.size(); i++) {
 
@@ -201,19 +193,21 @@ bool Decorator::process()
         //  END CRITICAL SECTION  //
     }
 
-    // Decorate frame
-    drawOnFrame();
+    // Wait for sources to read and lease the next shared frame
+    auto decorated = frame_sink_.acquire();
 
-    // START CRITICAL SECTION //
-    ////////////////////////////
+    // Copy straight from one node into the next
+    frame->copyTo(*decorated);
 
-    // Wait for sources to read
-    frame_sink_.wait();
+    // Tell sink it can continue
+    frame.release();
 
-    internal_frame_.copyTo(shared_frame_);
+    // Decorate frame in place
+    internal_frame_ = *decorated;
+    drawOnFrame();
 
     // Tell sources there is new data
-    frame_sink_.post();
+    decorated.release();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
@@ -95,7 +95,7 @@ private:
     // Decorator name
     std::string name_;
 
-    // Internal frame copy
+    // Frame being decorated. Refers to the shared frame leased from the sink.
     oat::Frame internal_frame_;
 
     // Mat client object for receiving frames
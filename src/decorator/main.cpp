@@ -30,6 +30,7 @@
 #include <boost/program_options.hpp>
 #include <boost/interprocess/exceptions.hpp>
 
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ProgramOptions.h"
 
@@ -82,6 +83,7 @@ void sigHandler(int) {
 int main(int argc, char *argv[]) {
 
     std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
 
     // Results of command line input
     std::string source;
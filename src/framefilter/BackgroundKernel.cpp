@@ -0,0 +1,837 @@
+//******************************************************************************
+//* File:   BackgroundKernel.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "BackgroundKernel.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Vector kernels are compiled for their own instruction set and picked at run
+// time, so the build does not need -march flags and the binary still runs on
+// older CPUs.
+#if defined(__GNUC__) && defined(__x86_64__)
+#define OAT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace oat {
+namespace kernel {
+
+namespace {
+
+static constexpr int32_t ROUND_ALPHA {1 << (ALPHA_FRAC_BITS - 1)};
+static constexpr int32_t ROUND_BACKGROUND {1 << (BACKGROUND_FRAC_BITS - 1)};
+
+inline uint8_t subtractAdaptOne(uint8_t f, uint16_t &b, int32_t alpha)
+{
+    const int32_t d = (static_cast<int32_t>(f) << BACKGROUND_FRAC_BITS) - b;
+    b = static_cast<uint16_t>(b + ((d * alpha + ROUND_ALPHA) >> ALPHA_FRAC_BITS));
+    const int32_t r = f - ((b + ROUND_BACKGROUND) >> BACKGROUND_FRAC_BITS);
+    return static_cast<uint8_t>(r > 0 ? r : 0);
+}
+
+inline uint8_t sigmaDeltaOne(uint8_t f, uint16_t &b, int32_t step)
+{
+    const int32_t target = static_cast<int32_t>(f) << BACKGROUND_FRAC_BITS;
+    const int32_t m = b;
+    b = static_cast<uint16_t>(target > m ? std::min(m + step, target)
+                                         : std::max(m - step, target));
+    const int32_t d = f - ((b + ROUND_BACKGROUND) >> BACKGROUND_FRAC_BITS);
+    return static_cast<uint8_t>(d < 0 ? -d : d);
+}
+
+inline uint8_t sigmaDeltaVarianceOne(uint8_t d,
+                                     uint16_t &variance,
+                                     int32_t step,
+                                     int32_t gain,
+                                     int32_t v_min,
+                                     int32_t v_max)
+{
+    int32_t v = variance;
+    if (d != 0) {
+        const int32_t target = std::min<int32_t>(gain * d, 255) << BACKGROUND_FRAC_BITS;
+        v = target > v ? std::min(v + step, target) : std::max(v - step, target);
+        v = std::min(std::max(v, v_min), v_max);
+        variance = static_cast<uint16_t>(v);
+    }
+
+    return d > ((v + ROUND_BACKGROUND) >> BACKGROUND_FRAC_BITS) ? 255 : 0;
+}
+
+void subtractScalar(const uint8_t *frame,
+                    const uint8_t *background,
+                    uint8_t *out,
+                    size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = frame[i] > background[i] ? frame[i] - background[i] : 0;
+}
+
+void subtractAdaptScalar(const uint8_t *frame,
+                         uint16_t *background,
+                         uint8_t *out,
+                         size_t n,
+                         int32_t alpha)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = subtractAdaptOne(frame[i], background[i], alpha);
+}
+
+void sigmaDeltaScalar(const uint8_t *frame,
+                      uint16_t *background,
+                      uint8_t *diff,
+                      size_t n,
+                      uint16_t step)
+{
+    for (size_t i = 0; i < n; i++)
+        diff[i] = sigmaDeltaOne(frame[i], background[i], step);
+}
+
+void sigmaDeltaVarianceScalar(const uint8_t *diff,
+                              uint16_t *variance,
+                              uint8_t *mask,
+                              size_t n,
+                              uint16_t step,
+                              uint16_t gain,
+                              uint16_t v_min,
+                              uint16_t v_max)
+{
+    for (size_t i = 0; i < n; i++)
+        mask[i] = sigmaDeltaVarianceOne(diff[i], variance[i], step, gain, v_min, v_max);
+}
+
+void maxChannels3Scalar(const uint8_t *in, uint8_t *out, size_t pixels)
+{
+    for (size_t p = 0; p < pixels; p++)
+        out[p] = std::max(std::max(in[3 * p], in[3 * p + 1]), in[3 * p + 2]);
+}
+
+void maskPixelsScalar(const uint8_t *in,
+                      const uint8_t *mask,
+                      uint8_t *out,
+                      size_t pixels,
+                      int channels)
+{
+    for (size_t p = 0; p < pixels; p++)
+        for (int c = 0; c < channels; c++)
+            out[p * channels + c] = in[p * channels + c] & mask[p];
+}
+
+// The stages of sigmaDeltaSegment3 run in turn on blocks of pixels small
+// enough for their differences to stay in L1. Each stage picks its own
+// vector kernel.
+void sigmaDeltaSegment3Staged(const uint8_t *in,
+                              uint16_t *background,
+                              uint16_t *variance,
+                              uint8_t *out,
+                              size_t pixels,
+                              uint16_t step,
+                              uint16_t gain,
+                              uint16_t v_min,
+                              uint16_t v_max)
+{
+    static constexpr size_t BLOCK {256};
+    uint8_t diff[3 * BLOCK];
+
+    for (size_t p = 0; p < pixels; p += BLOCK) {
+
+        const size_t k = std::min(BLOCK, pixels - p);
+
+        sigmaDelta(in + 3 * p, background + 3 * p, diff, 3 * k, step);
+        maxChannels3(diff, diff, k);
+        sigmaDeltaVariance(diff, variance + p, diff, k, step, gain, v_min, v_max);
+        maskPixels(in + 3 * p, diff, out + 3 * p, k, 3);
+    }
+}
+
+#ifdef OAT_X86_KERNELS
+
+__attribute__((target("avx2")))
+void subtractAVX2(const uint8_t *frame,
+                  const uint8_t *background,
+                  uint8_t *out,
+                  size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(frame + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(background + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_subs_epu8(f, b));
+    }
+
+    subtractScalar(frame + i, background + i, out + i, n - i);
+}
+
+__attribute__((target("sse2")))
+void subtractSSE2(const uint8_t *frame,
+                  const uint8_t *background,
+                  uint8_t *out,
+                  size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i *>(frame + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(background + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_subs_epu8(f, b));
+    }
+
+    subtractScalar(frame + i, background + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void subtractAdaptAVX2(const uint8_t *frame,
+                       uint16_t *background,
+                       uint8_t *out,
+                       size_t n,
+                       int32_t alpha)
+{
+    const __m256i a = _mm256_set1_epi32(alpha);
+    const __m256i round_a = _mm256_set1_epi32(ROUND_ALPHA);
+    const __m256i round_b = _mm256_set1_epi32(ROUND_BACKGROUND);
+    const __m256i zero = _mm256_setzero_si256();
+
+    // 8 samples per iteration, widened to 32 bits
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+
+        int64_t f8;
+        std::memcpy(&f8, frame + i, sizeof(f8));
+        const __m256i f = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(f8));
+        __m256i b = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(background + i)));
+
+        // b += (((f << 8) - b) * alpha + round) >> 15
+        __m256i d = _mm256_sub_epi32(_mm256_slli_epi32(f, BACKGROUND_FRAC_BITS), b);
+        d = _mm256_mullo_epi32(d, a);
+        d = _mm256_srai_epi32(_mm256_add_epi32(d, round_a), ALPHA_FRAC_BITS);
+        b = _mm256_add_epi32(b, d);
+
+        // max(f - round(b >> 8), 0)
+        __m256i r = _mm256_srli_epi32(_mm256_add_epi32(b, round_b), BACKGROUND_FRAC_BITS);
+        r = _mm256_max_epi32(_mm256_sub_epi32(f, r), zero);
+
+        const __m128i b16 = _mm_packus_epi32(_mm256_castsi256_si128(b),
+                                             _mm256_extracti128_si256(b, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(background + i), b16);
+
+        const __m128i r16 = _mm_packus_epi32(_mm256_castsi256_si128(r),
+                                             _mm256_extracti128_si256(r, 1));
+        const int64_t r8 = _mm_cvtsi128_si64(_mm_packus_epi16(r16, r16));
+        std::memcpy(out + i, &r8, sizeof(r8));
+    }
+
+    subtractAdaptScalar(frame + i, background + i, out + i, n - i, alpha);
+}
+
+__attribute__((target("sse4.1")))
+void subtractAdaptSSE41(const uint8_t *frame,
+                        uint16_t *background,
+                        uint8_t *out,
+                        size_t n,
+                        int32_t alpha)
+{
+    const __m128i a = _mm_set1_epi32(alpha);
+    const __m128i round_a = _mm_set1_epi32(ROUND_ALPHA);
+    const __m128i round_b = _mm_set1_epi32(ROUND_BACKGROUND);
+    const __m128i zero = _mm_setzero_si128();
+
+    // 4 samples per iteration, widened to 32 bits
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+
+        int32_t f4;
+        std::memcpy(&f4, frame + i, sizeof(f4));
+        const __m128i f = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(f4));
+        __m128i b = _mm_cvtepu16_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(background + i)));
+
+        __m128i d = _mm_sub_epi32(_mm_slli_epi32(f, BACKGROUND_FRAC_BITS), b);
+        d = _mm_mullo_epi32(d, a);
+        d = _mm_srai_epi32(_mm_add_epi32(d, round_a), ALPHA_FRAC_BITS);
+        b = _mm_add_epi32(b, d);
+
+        __m128i r = _mm_srli_epi32(_mm_add_epi32(b, round_b), BACKGROUND_FRAC_BITS);
+        r = _mm_max_epi32(_mm_sub_epi32(f, r), zero);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(background + i),
+                         _mm_packus_epi32(b, b));
+
+        const __m128i r16 = _mm_packus_epi32(r, r);
+        const int32_t r4 = _mm_cvtsi128_si32(_mm_packus_epi16(r16, r16));
+        std::memcpy(out + i, &r4, sizeof(r4));
+    }
+
+    subtractAdaptScalar(frame + i, background + i, out + i, n - i, alpha);
+}
+
+// Background step of 16 samples. Returns their absolute differences from the
+// updated background.
+__attribute__((target("avx2")))
+inline __m128i sigmaDelta16(const __m128i f8,
+                            uint16_t *background,
+                            const __m256i s,
+                            const __m256i round_b)
+{
+    const __m256i f = _mm256_slli_epi16(_mm256_cvtepu8_epi16(f8), BACKGROUND_FRAC_BITS);
+    const __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(background));
+
+    // Step towards the frame without overshooting it
+    const __m256i up = _mm256_min_epu16(_mm256_adds_epu16(m, s), f);
+    const __m256i down = _mm256_max_epu16(_mm256_subs_epu16(m, s), f);
+    const __m256i below = _mm256_cmpeq_epi16(_mm256_max_epu16(f, m), m);
+    const __m256i b = _mm256_blendv_epi8(up, down, below);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(background), b);
+
+    // |f - round(b >> 8)|
+    const __m256i r = _mm256_srli_epi16(_mm256_adds_epu16(b, round_b), BACKGROUND_FRAC_BITS);
+    const __m128i r8 = _mm_packus_epi16(_mm256_castsi256_si128(r),
+                                        _mm256_extracti128_si256(r, 1));
+    return _mm_or_si128(_mm_subs_epu8(f8, r8), _mm_subs_epu8(r8, f8));
+}
+
+__attribute__((target("avx2")))
+void sigmaDeltaAVX2(const uint8_t *frame,
+                    uint16_t *background,
+                    uint8_t *diff,
+                    size_t n,
+                    uint16_t step)
+{
+    const __m256i s = _mm256_set1_epi16(static_cast<short>(step));
+    const __m256i round_b = _mm256_set1_epi16(ROUND_BACKGROUND);
+
+    // 16 samples per iteration, widened to 16 bits
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i f8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(frame + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(diff + i),
+                         sigmaDelta16(f8, background + i, s, round_b));
+    }
+
+    sigmaDeltaScalar(frame + i, background + i, diff + i, n - i, step);
+}
+
+__attribute__((target("sse4.1")))
+void sigmaDeltaSSE41(const uint8_t *frame,
+                     uint16_t *background,
+                     uint8_t *diff,
+                     size_t n,
+                     uint16_t step)
+{
+    const __m128i s = _mm_set1_epi16(static_cast<short>(step));
+    const __m128i round_b = _mm_set1_epi16(ROUND_BACKGROUND);
+
+    // 8 samples per iteration, widened to 16 bits
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+
+        const __m128i f8 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(frame + i));
+        const __m128i f = _mm_slli_epi16(_mm_cvtepu8_epi16(f8), BACKGROUND_FRAC_BITS);
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(background + i));
+
+        const __m128i up = _mm_min_epu16(_mm_adds_epu16(m, s), f);
+        const __m128i down = _mm_max_epu16(_mm_subs_epu16(m, s), f);
+        const __m128i below = _mm_cmpeq_epi16(_mm_max_epu16(f, m), m);
+        const __m128i b = _mm_blendv_epi8(up, down, below);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(background + i), b);
+
+        const __m128i r = _mm_srli_epi16(_mm_adds_epu16(b, round_b), BACKGROUND_FRAC_BITS);
+        const __m128i r8 = _mm_packus_epi16(r, r);
+        const __m128i d = _mm_or_si128(_mm_subs_epu8(f8, r8), _mm_subs_epu8(r8, f8));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(diff + i), d);
+    }
+
+    sigmaDeltaScalar(frame + i, background + i, diff + i, n - i, step);
+}
+
+// Constants of the sigma-delta variance step
+struct VarianceConstants {
+
+    __attribute__((target("avx2")))
+    VarianceConstants(uint16_t step, uint16_t gain, uint16_t v_min, uint16_t v_max)
+    : s(_mm256_set1_epi16(static_cast<short>(step)))
+    , g(_mm256_set1_epi16(static_cast<short>(gain)))
+    , lo(_mm256_set1_epi16(static_cast<short>(v_min)))
+    , hi(_mm256_set1_epi16(static_cast<short>(v_max)))
+    , max_d(_mm256_set1_epi16(255))
+    , round_b(_mm256_set1_epi16(ROUND_BACKGROUND))
+    {
+        // Nothing
+    }
+
+    const __m256i s, g, lo, hi, max_d, round_b;
+};
+
+// Variance step of 16 pixels. Returns their foreground mask.
+__attribute__((target("avx2")))
+inline __m128i sigmaDeltaVariance16(const __m128i d8,
+                                    uint16_t *variance,
+                                    const VarianceConstants &k)
+{
+    const __m256i d = _mm256_cvtepu8_epi16(d8);
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(variance));
+
+    // Step towards gain * d, within [v_min, v_max]
+    const __m256i t = _mm256_slli_epi16(
+        _mm256_min_epu16(_mm256_mullo_epi16(d, k.g), k.max_d), BACKGROUND_FRAC_BITS);
+    const __m256i up = _mm256_min_epu16(_mm256_adds_epu16(v, k.s), t);
+    const __m256i down = _mm256_max_epu16(_mm256_subs_epu16(v, k.s), t);
+    const __m256i below = _mm256_cmpeq_epi16(_mm256_max_epu16(t, v), v);
+    __m256i w = _mm256_blendv_epi8(up, down, below);
+    w = _mm256_min_epu16(_mm256_max_epu16(w, k.lo), k.hi);
+
+    // Only where there is a difference
+    w = _mm256_blendv_epi8(w, v, _mm256_cmpeq_epi16(d, _mm256_setzero_si256()));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(variance), w);
+
+    // d > round(w >> 8). Both are at most 255, so a signed compare works.
+    const __m256i r = _mm256_srli_epi16(_mm256_adds_epu16(w, k.round_b), BACKGROUND_FRAC_BITS);
+    const __m256i fg = _mm256_cmpgt_epi16(d, r);
+    return _mm_packs_epi16(_mm256_castsi256_si128(fg), _mm256_extracti128_si256(fg, 1));
+}
+
+__attribute__((target("avx2")))
+void sigmaDeltaVarianceAVX2(const uint8_t *diff,
+                            uint16_t *variance,
+                            uint8_t *mask,
+                            size_t n,
+                            uint16_t step,
+                            uint16_t gain,
+                            uint16_t v_min,
+                            uint16_t v_max)
+{
+    const VarianceConstants k(step, gain, v_min, v_max);
+
+    // 16 pixels per iteration, widened to 16 bits
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(diff + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(mask + i),
+                         sigmaDeltaVariance16(d, variance + i, k));
+    }
+
+    sigmaDeltaVarianceScalar(diff + i, variance + i, mask + i, n - i,
+                             step, gain, v_min, v_max);
+}
+
+__attribute__((target("sse4.1")))
+void sigmaDeltaVarianceSSE41(const uint8_t *diff,
+                             uint16_t *variance,
+                             uint8_t *mask,
+                             size_t n,
+                             uint16_t step,
+                             uint16_t gain,
+                             uint16_t v_min,
+                             uint16_t v_max)
+{
+    const __m128i s = _mm_set1_epi16(static_cast<short>(step));
+    const __m128i g = _mm_set1_epi16(static_cast<short>(gain));
+    const __m128i lo = _mm_set1_epi16(static_cast<short>(v_min));
+    const __m128i hi = _mm_set1_epi16(static_cast<short>(v_max));
+    const __m128i max_d = _mm_set1_epi16(255);
+    const __m128i round_b = _mm_set1_epi16(ROUND_BACKGROUND);
+    const __m128i zero = _mm_setzero_si128();
+
+    // 8 pixels per iteration, widened to 16 bits
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+
+        const __m128i d = _mm_cvtepu8_epi16(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(diff + i)));
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(variance + i));
+
+        const __m128i t = _mm_slli_epi16(
+            _mm_min_epu16(_mm_mullo_epi16(d, g), max_d), BACKGROUND_FRAC_BITS);
+        const __m128i up = _mm_min_epu16(_mm_adds_epu16(v, s), t);
+        const __m128i down = _mm_max_epu16(_mm_subs_epu16(v, s), t);
+        const __m128i below = _mm_cmpeq_epi16(_mm_max_epu16(t, v), v);
+        __m128i w = _mm_blendv_epi8(up, down, below);
+        w = _mm_min_epu16(_mm_max_epu16(w, lo), hi);
+
+        w = _mm_blendv_epi8(w, v, _mm_cmpeq_epi16(d, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(variance + i), w);
+
+        const __m128i r = _mm_srli_epi16(_mm_adds_epu16(w, round_b), BACKGROUND_FRAC_BITS);
+        const __m128i fg = _mm_cmpgt_epi16(d, r);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(mask + i), _mm_packs_epi16(fg, fg));
+    }
+
+    sigmaDeltaVarianceScalar(diff + i, variance + i, mask + i, n - i,
+                             step, gain, v_min, v_max);
+}
+
+// Largest channel of each of 16 pixels held in three 16-byte blocks
+__attribute__((target("ssse3")))
+inline __m128i maxChannels3Block(const __m128i a, const __m128i b, const __m128i c)
+{
+    // Gather one channel of 16 pixels from three 16-byte blocks
+    const __m128i c0a = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i c0b = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i c0c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i c1a = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i c1b = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i c1c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i c2a = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i c2b = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i c2c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+    const __m128i ch0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, c0a),
+                                                  _mm_shuffle_epi8(b, c0b)),
+                                     _mm_shuffle_epi8(c, c0c));
+    const __m128i ch1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, c1a),
+                                                  _mm_shuffle_epi8(b, c1b)),
+                                     _mm_shuffle_epi8(c, c1c));
+    const __m128i ch2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, c2a),
+                                                  _mm_shuffle_epi8(b, c2b)),
+                                     _mm_shuffle_epi8(c, c2c));
+
+    return _mm_max_epu8(_mm_max_epu8(ch0, ch1), ch2);
+}
+
+// Mask 16 pixels held in three 16-byte blocks and store them
+__attribute__((target("ssse3")))
+inline void maskBlock3(const __m128i m,
+                       const __m128i a,
+                       const __m128i b,
+                       const __m128i c,
+                       uint8_t *out)
+{
+    // Repeat each of 16 mask bytes three times across three blocks
+    const __m128i ea = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+    const __m128i eb = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+    const __m128i ec = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                     _mm_and_si128(a, _mm_shuffle_epi8(m, ea)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16),
+                     _mm_and_si128(b, _mm_shuffle_epi8(m, eb)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 32),
+                     _mm_and_si128(c, _mm_shuffle_epi8(m, ec)));
+}
+
+__attribute__((target("ssse3")))
+void maxChannels3SSSE3(const uint8_t *in, uint8_t *out, size_t pixels)
+{
+    // Output block p is written after input blocks 3p to 3p + 2 are read,
+    // so in and out may be the same
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 3 * p));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 3 * p + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 3 * p + 32));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + p), maxChannels3Block(a, b, c));
+    }
+
+    maxChannels3Scalar(in + 3 * p, out + p, pixels - p);
+}
+
+__attribute__((target("ssse3")))
+void maskPixelsSSSE3(const uint8_t *in,
+                     const uint8_t *mask,
+                     uint8_t *out,
+                     size_t pixels,
+                     int channels)
+{
+    size_t p = 0;
+
+    if (channels == 1) {
+        for (; p + 16 <= pixels; p += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + p));
+            const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + p));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + p), _mm_and_si128(v, m));
+        }
+    } else if (channels == 3) {
+        for (; p + 16 <= pixels; p += 16) {
+
+            const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + p));
+            const uint8_t *i = in + 3 * p;
+
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i + 16));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i + 32));
+
+            maskBlock3(m, a, b, c, out + 3 * p);
+        }
+    }
+
+    maskPixelsScalar(in + p * channels, mask + p, out + p * channels, pixels - p, channels);
+}
+
+__attribute__((target("avx2")))
+void sigmaDeltaSegment3AVX2(const uint8_t *in,
+                            uint16_t *background,
+                            uint16_t *variance,
+                            uint8_t *out,
+                            size_t pixels,
+                            uint16_t step,
+                            uint16_t gain,
+                            uint16_t v_min,
+                            uint16_t v_max)
+{
+    const __m256i s = _mm256_set1_epi16(static_cast<short>(step));
+    const __m256i round_b = _mm256_set1_epi16(ROUND_BACKGROUND);
+    const VarianceConstants k(step, gain, v_min, v_max);
+
+    // 16 pixels per iteration. Everything stays in registers between
+    // stages, and the pixels are stored after they are read, so in and out
+    // may be the same.
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+
+        const uint8_t *i = in + 3 * p;
+        uint16_t *b = background + 3 * p;
+
+        const __m128i f0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i));
+        const __m128i f1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i + 16));
+        const __m128i f2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i + 32));
+
+        const __m128i d = maxChannels3Block(sigmaDelta16(f0, b, s, round_b),
+                                            sigmaDelta16(f1, b + 16, s, round_b),
+                                            sigmaDelta16(f2, b + 32, s, round_b));
+
+        maskBlock3(sigmaDeltaVariance16(d, variance + p, k), f0, f1, f2, out + 3 * p);
+    }
+
+    sigmaDeltaSegment3Staged(in + 3 * p, background + 3 * p, variance + p,
+                             out + 3 * p, pixels - p, step, gain, v_min, v_max);
+}
+
+#endif /* OAT_X86_KERNELS */
+
+using SubtractFn = void (*)(const uint8_t *, const uint8_t *, uint8_t *, size_t);
+using SubtractAdaptFn = void (*)(const uint8_t *, uint16_t *, uint8_t *, size_t, int32_t);
+using SigmaDeltaFn = void (*)(const uint8_t *, uint16_t *, uint8_t *, size_t, uint16_t);
+using MaxChannels3Fn = void (*)(const uint8_t *, uint8_t *, size_t);
+using MaskPixelsFn = void (*)(const uint8_t *, const uint8_t *, uint8_t *, size_t, int);
+using SigmaDeltaVarianceFn = void (*)(const uint8_t *, uint16_t *, uint8_t *, size_t,
+                                      uint16_t, uint16_t, uint16_t, uint16_t);
+using SigmaDeltaSegment3Fn = void (*)(const uint8_t *, uint16_t *, uint16_t *, uint8_t *,
+                                      size_t, uint16_t, uint16_t, uint16_t, uint16_t);
+
+SubtractFn selectSubtract()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("avx2"))
+        return subtractAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return subtractSSE2;
+#endif
+    return subtractScalar;
+}
+
+SubtractFn subtractFor(KernelPath path)
+{
+    switch (path) {
+#ifdef OAT_X86_KERNELS
+        case KernelPath::AVX2:
+            return subtractAVX2;
+        case KernelPath::SSE:
+            return subtractSSE2;
+#endif
+        default:
+            return subtractScalar;
+    }
+}
+
+SubtractAdaptFn subtractAdaptFor(KernelPath path)
+{
+    switch (path) {
+#ifdef OAT_X86_KERNELS
+        case KernelPath::AVX2:
+            return subtractAdaptAVX2;
+        case KernelPath::SSE:
+            return subtractAdaptSSE41;
+#endif
+        default:
+            return subtractAdaptScalar;
+    }
+}
+
+SubtractAdaptFn selectSubtractAdapt()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("avx2"))
+        return subtractAdaptAVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return subtractAdaptSSE41;
+#endif
+    return subtractAdaptScalar;
+}
+
+SigmaDeltaFn selectSigmaDelta()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("avx2"))
+        return sigmaDeltaAVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return sigmaDeltaSSE41;
+#endif
+    return sigmaDeltaScalar;
+}
+
+SigmaDeltaVarianceFn selectSigmaDeltaVariance()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("avx2"))
+        return sigmaDeltaVarianceAVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return sigmaDeltaVarianceSSE41;
+#endif
+    return sigmaDeltaVarianceScalar;
+}
+
+SigmaDeltaSegment3Fn selectSigmaDeltaSegment3()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("avx2"))
+        return sigmaDeltaSegment3AVX2;
+#endif
+    return sigmaDeltaSegment3Staged;
+}
+
+MaxChannels3Fn selectMaxChannels3()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("ssse3"))
+        return maxChannels3SSSE3;
+#endif
+    return maxChannels3Scalar;
+}
+
+MaskPixelsFn selectMaskPixels()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("ssse3"))
+        return maskPixelsSSSE3;
+#endif
+    return maskPixelsScalar;
+}
+
+} /* namespace */
+
+void subtract(const uint8_t *frame,
+              const uint8_t *background,
+              uint8_t *out,
+              size_t n)
+{
+    static const SubtractFn fn = selectSubtract();
+    fn(frame, background, out, n);
+}
+
+void subtractAdapt(const uint8_t *frame,
+                   uint16_t *background,
+                   uint8_t *out,
+                   size_t n,
+                   int32_t alpha)
+{
+    static const SubtractAdaptFn fn = selectSubtractAdapt();
+    fn(frame, background, out, n, alpha);
+}
+
+bool supported(KernelPath path)
+{
+    switch (path) {
+        case KernelPath::SCALAR:
+            return true;
+#ifdef OAT_X86_KERNELS
+        case KernelPath::SSE:
+            return __builtin_cpu_supports("sse4.1");
+        case KernelPath::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+void subtract(KernelPath path,
+              const uint8_t *frame,
+              const uint8_t *background,
+              uint8_t *out,
+              size_t n)
+{
+    subtractFor(path)(frame, background, out, n);
+}
+
+void subtractAdapt(KernelPath path,
+                   const uint8_t *frame,
+                   uint16_t *background,
+                   uint8_t *out,
+                   size_t n,
+                   int32_t alpha)
+{
+    subtractAdaptFor(path)(frame, background, out, n, alpha);
+}
+
+void sigmaDelta(const uint8_t *frame,
+                uint16_t *background,
+                uint8_t *diff,
+                size_t n,
+                uint16_t step)
+{
+    static const SigmaDeltaFn fn = selectSigmaDelta();
+    fn(frame, background, diff, n, step);
+}
+
+void sigmaDeltaVariance(const uint8_t *diff,
+                        uint16_t *variance,
+                        uint8_t *mask,
+                        size_t n,
+                        uint16_t step,
+                        uint16_t gain,
+                        uint16_t v_min,
+                        uint16_t v_max)
+{
+    static const SigmaDeltaVarianceFn fn = selectSigmaDeltaVariance();
+    fn(diff, variance, mask, n, step, gain, v_min, v_max);
+}
+
+void sigmaDeltaSegment3(const uint8_t *in,
+                        uint16_t *background,
+                        uint16_t *variance,
+                        uint8_t *out,
+                        size_t pixels,
+                        uint16_t step,
+                        uint16_t gain,
+                        uint16_t v_min,
+                        uint16_t v_max)
+{
+    static const SigmaDeltaSegment3Fn fn = selectSigmaDeltaSegment3();
+    fn(in, background, variance, out, pixels, step, gain, v_min, v_max);
+}
+
+void maxChannels3(const uint8_t *in, uint8_t *out, size_t pixels)
+{
+    static const MaxChannels3Fn fn = selectMaxChannels3();
+    fn(in, out, pixels);
+}
+
+void maskPixels(const uint8_t *in,
+                const uint8_t *mask,
+                uint8_t *out,
+                size_t pixels,
+                int channels)
+{
+    static const MaskPixelsFn fn = selectMaskPixels();
+    fn(in, mask, out, pixels, channels);
+}
+
+} /* namespace kernel */
+} /* namespace oat */
@@ -0,0 +1,198 @@
+//******************************************************************************
+//* File:   BackgroundKernel.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BACKGROUNDKERNEL_H
+#define	OAT_BACKGROUNDKERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace oat {
+namespace kernel {
+
+// Fractional bits of the fixed-point background model
+static constexpr int BACKGROUND_FRAC_BITS {8};
+
+// Fractional bits of the fixed-point adaptation coefficient
+static constexpr int ALPHA_FRAC_BITS {15};
+
+/**
+ * @brief Saturating subtraction of a static background,
+ * out[i] = max(frame[i] - background[i], 0).
+ * @param frame Input samples
+ * @param background Background samples
+ * @param out Output samples. May be the same as frame.
+ * @param n Number of samples (pixels x channels)
+ */
+void subtract(const uint8_t *frame,
+              const uint8_t *background,
+              uint8_t *out,
+              size_t n);
+
+/**
+ * @brief Update an adaptive background and subtract it in a single pass.
+ * The background is stored as 8.8 fixed-point values and moves towards each
+ * frame by alpha of the difference. The rounded, updated background is
+ * subtracted from the frame with saturation. Equivalent to
+ * cv::accumulateWeighted followed by conversion to 8 bits and cv::subtract,
+ * except that background changes smaller than 1 / (512 * alpha) of an
+ * intensity level are ignored.
+ * @param frame Input samples
+ * @param background 8.8 fixed-point background samples, updated in place
+ * @param out Output samples. May be the same as frame.
+ * @param n Number of samples (pixels x channels)
+ * @param alpha Adaptation coefficient with ALPHA_FRAC_BITS fractional bits,
+ * 0 to 1 << ALPHA_FRAC_BITS
+ */
+void subtractAdapt(const uint8_t *frame,
+                   uint16_t *background,
+                   uint8_t *out,
+                   size_t n,
+                   int32_t alpha);
+
+/**
+ * Instruction sets that subtract and subtractAdapt are written for. The
+ * functions above run the best one that the CPU supports. The overloads
+ * below run a given one so that tests can compare them.
+ */
+enum class KernelPath {
+    SCALAR, //!< Portable C++
+    SSE,    //!< SSE2 and SSE4.1
+    AVX2    //!< AVX2
+};
+
+/**
+ * @brief Check if a kernel path was built and can run on this CPU.
+ * @param path Kernel path
+ */
+bool supported(KernelPath path);
+
+/**
+ * @brief subtract, using a given kernel path, which must be supported.
+ */
+void subtract(KernelPath path,
+              const uint8_t *frame,
+              const uint8_t *background,
+              uint8_t *out,
+              size_t n);
+
+/**
+ * @brief subtractAdapt, using a given kernel path, which must be supported.
+ */
+void subtractAdapt(KernelPath path,
+                   const uint8_t *frame,
+                   uint16_t *background,
+                   uint8_t *out,
+                   size_t n,
+                   int32_t alpha);
+
+/**
+ * @brief Background step of a sigma-delta background estimator. Moves each
+ * 8.8 fixed-point background sample towards the frame by at most step, then
+ * writes the absolute difference between the frame and the rounded
+ * background.
+ * @param frame Input samples
+ * @param background 8.8 fixed-point background samples, updated in place
+ * @param diff Output absolute differences
+ * @param n Number of samples (pixels x channels)
+ * @param step Largest background change, 8.8 fixed-point
+ */
+void sigmaDelta(const uint8_t *frame,
+                uint16_t *background,
+                uint8_t *diff,
+                size_t n,
+                uint16_t step);
+
+/**
+ * @brief Variance step and foreground decision of a sigma-delta background
+ * estimator. Where a pixel differs from the background, its 8.8 fixed-point
+ * variance moves towards gain times the difference by at most step, within
+ * [v_min, v_max]. Pixels whose difference exceeds their rounded variance are
+ * foreground.
+ * @param diff Absolute difference of each pixel from the background
+ * @param variance 8.8 fixed-point variance of each pixel, updated in place
+ * @param mask Output, 255 for foreground pixels and 0 otherwise. May be the
+ * same as diff.
+ * @param n Number of pixels
+ * @param step Largest variance change, 8.8 fixed-point
+ * @param gain Multiple of the difference followed by the variance, 1 to 16
+ * @param v_min Smallest variance, 8.8 fixed-point
+ * @param v_max Largest variance, 8.8 fixed-point
+ */
+void sigmaDeltaVariance(const uint8_t *diff,
+                        uint16_t *variance,
+                        uint8_t *mask,
+                        size_t n,
+                        uint16_t step,
+                        uint16_t gain,
+                        uint16_t v_min,
+                        uint16_t v_max);
+
+/**
+ * @brief Complete sigma-delta step for a row of 3-channel pixels: the
+ * background step of each channel, then the variance step and foreground
+ * decision on the largest channel difference of each pixel, then masking.
+ * Equivalent to sigmaDelta, maxChannels3, sigmaDeltaVariance and maskPixels
+ * in turn, but makes a single pass over the row.
+ * @param in Interleaved 3-channel samples
+ * @param background 8.8 fixed-point background samples, updated in place
+ * @param variance 8.8 fixed-point variance of each pixel, updated in place
+ * @param out Output samples, in where a pixel is foreground and 0 otherwise.
+ * May be the same as in.
+ * @param pixels Number of pixels
+ * @param step Largest background and variance change, 8.8 fixed-point
+ * @param gain Multiple of the difference followed by the variance, 1 to 16
+ * @param v_min Smallest variance, 8.8 fixed-point
+ * @param v_max Largest variance, 8.8 fixed-point
+ */
+void sigmaDeltaSegment3(const uint8_t *in,
+                        uint16_t *background,
+                        uint16_t *variance,
+                        uint8_t *out,
+                        size_t pixels,
+                        uint16_t step,
+                        uint16_t gain,
+                        uint16_t v_min,
+                        uint16_t v_max);
+
+/**
+ * @brief Largest channel value of each pixel of a 3-channel row.
+ * @param in Interleaved 3-channel samples
+ * @param out Output, one value per pixel. May be the same as in.
+ * @param pixels Number of pixels
+ */
+void maxChannels3(const uint8_t *in, uint8_t *out, size_t pixels);
+
+/**
+ * @brief Keep the pixels selected by a mask and zero the rest.
+ * @param in Input samples
+ * @param mask One value per pixel, 255 to keep the pixel or 0 to zero it
+ * @param out Output samples. May be the same as in.
+ * @param pixels Number of pixels
+ * @param channels Channels per pixel, 1 or 3
+ */
+void maskPixels(const uint8_t *in,
+                const uint8_t *mask,
+                uint8_t *out,
+                size_t pixels,
+                int channels);
+
+}      /* namespace kernel */
+}      /* namespace oat */
+#endif /* OAT_BACKGROUNDKERNEL_H */
@@ -19,6 +19,7 @@
 
 #include "BackgroundSubtractor.h"
 
+#include <cmath>
 #include <string>
 #include <iostream>
 #include <cpptoml.h>
@@ -30,6 +31,8 @@
 #include "../../lib/utility/ProgramOptions.h"
 #include "../../lib/utility/TOMLSanitize.h"
 
+#include "BackgroundKernel.h"
+
 namespace oat {
 
 BackgroundSubtractor::BackgroundSubtractor(
@@ -64,33 +67,33 @@ void BackgroundSubtractor::appendOptions(po::options_description &opts)
         config_keys_.push_back(o->long_name());
 }
 
-void BackgroundSubtractor::configure(const po::variables_map &vm)
+void BackgroundSubtractor::configureFilter(const po::variables_map &vm,
+                                             const config::OptionTable &config_table)
 {
-    // Check for config file and entry correctness
-    auto config_table = oat::config::getConfigTable(vm);
-    oat::config::checkKeys(config_keys_, config_table);
-
     // Background image path
     std::string img_path;
     if (oat::config::getValue(vm, config_table, "background", img_path)) {
 
         // TODO: Color image only?
-        background_frame_ = cv::imread(img_path, CV_LOAD_IMAGE_COLOR);
+        cv::Mat background = cv::imread(img_path, CV_LOAD_IMAGE_COLOR);
 
-        if (background_frame_.data == NULL)
+        if (background.data == NULL)
             throw (std::runtime_error("File \"" + img_path + "\" could not be read."));
 
-        background_set_ = true;
+        // Also sets the fixed-point copy used for adaptation
+        setBackgroundImage(background);
     }
 
     // Adaptation coefficient
-    oat::config::getNumericValue<double>(vm, config_table, "adaptation-coeff", alpha_, 0.0, 1.0);
+    double alpha = 0.0;
+    oat::config::getNumericValue<double>(vm, config_table, "adaptation-coeff", alpha, 0.0, 1.0);
+    alpha_ = static_cast<int32_t>(std::lround(alpha * (1 << kernel::ALPHA_FRAC_BITS)));
 }
 
 void BackgroundSubtractor::setBackgroundImage(const cv::Mat &frame)
 {
     background_frame_ = frame.clone();
-    frame.clone().convertTo(background_frame_f_, CV_32F);
+    frame.convertTo(background_frame_q_, CV_16U, 1 << kernel::BACKGROUND_FRAC_BITS);
     background_set_ = true;
 }
 
@@ -101,12 +104,54 @@ void BackgroundSubtractor::filter(cv::Mat &frame)
     if (!background_set_)
         setBackgroundImage(frame);
 
-    if (alpha_ > 0.0) {
-       cv::accumulateWeighted(frame, background_frame_f_, alpha_);
-       background_frame_f_.convertTo(background_frame_, CV_8U);
-    }
+    subtract(frame, frame, cv::Range(0, frame.rows));
+}
+
+void BackgroundSubtractor::filter(const oat::Frame &in, oat::Frame &out)
+{
+    if (!background_set_)
+        setBackgroundImage(in);
+
+    subtract(in, out, cv::Range(0, in.rows));
+}
 
-    frame = frame - background_frame_;
+FrameFilter::Bands BackgroundSubtractor::bands() const
+{
+    // The first frame becomes the background and must be seen whole
+    return background_set_ ? Bands::POINTWISE : Bands::NONE;
+}
+
+void BackgroundSubtractor::filterBand(const oat::Frame &in,
+                                      oat::Frame &out,
+                                      const cv::Range &rows)
+{
+    subtract(in, out, rows);
+}
+
+void BackgroundSubtractor::subtract(const cv::Mat &in,
+                                    cv::Mat &out,
+                                    const cv::Range &rows)
+{
+    if (in.depth() != CV_8U
+        || in.size() != background_frame_.size()
+        || in.type() != background_frame_.type())
+        throw std::runtime_error("Background image and frames must have the "
+                                 "same size and 8-bit pixel type.");
+
+    const size_t n = in.cols * in.channels();
+
+    // When adapting, the 8-bit background is never updated. The fixed-point
+    // background is rounded on the fly instead.
+    for (int r = rows.start; r < rows.end; r++) {
+        if (alpha_ > 0)
+            kernel::subtractAdapt(in.ptr(r),
+                                  background_frame_q_.ptr<uint16_t>(r),
+                                  out.ptr(r),
+                                  n,
+                                  alpha_);
+        else
+            kernel::subtract(in.ptr(r), background_frame_.ptr(r), out.ptr(r), n);
+    }
 }
 
 } /* namespace oat */
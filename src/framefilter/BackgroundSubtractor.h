@@ -20,6 +20,8 @@
 #ifndef OAT_BACKGROUNDSUBTRACTOR_H
 #define	OAT_BACKGROUNDSUBTRACTOR_H
 
+#include <cstdint>
+
 #include "FrameFilter.h"
 
 namespace oat {
@@ -42,19 +44,21 @@ public:
                          const std::string &frame_sink_address);
 
     void appendOptions(po::options_description &opts) override;
-    void configure(const po::variables_map &vm) override;
 
 private:
 
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+
     // Is the background frame set?
     bool background_set_ {false};
 
-    // The background frame(s)
+    // The background frame, and the same in 8.8 fixed-point for adaptation
     cv::Mat background_frame_;
-    cv::Mat background_frame_f_;
+    cv::Mat background_frame_q_;
 
-    // Background update rate
-    double alpha_ {0.0};
+    // Background update rate, in kernel::ALPHA_FRAC_BITS fixed-point
+    int32_t alpha_ {0};
 
     /**
      * Apply background subtraction.
@@ -63,8 +67,33 @@ private:
      */
     void filter(cv::Mat &frame) override;
 
+    /**
+     * Apply background subtraction directly into the shared output frame.
+     * @param in Unfiltered frame
+     * @param out Filtered frame
+     */
+    void filter(const oat::Frame &in, oat::Frame &out) override;
+
+    /**
+     * Apply background subtraction to a band of rows. Only possible once the
+     * background frame has been set.
+     */
+    Bands bands(void) const override;
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+
     // Set the background frame
     void setBackgroundImage(const cv::Mat&);
+
+    /**
+     * Update the background and subtract it from a range of rows in a single
+     * pass.
+     * @param in Unfiltered frame
+     * @param out Filtered frame. May be the same as in.
+     * @param rows Rows to filter
+     */
+    void subtract(const cv::Mat &in, cv::Mat &out, const cv::Range &rows);
 };
 
 }      /* namespace oat */
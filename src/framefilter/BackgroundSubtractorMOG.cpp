@@ -73,12 +73,9 @@ void BackgroundSubtractorMOG::appendOptions(po::options_description &opts)
         config_keys_.push_back(o->long_name());
 }
 
-void BackgroundSubtractorMOG::configure(const po::variables_map &vm)
+void BackgroundSubtractorMOG::configureFilter(const po::variables_map &vm,
+                                                const config::OptionTable &config_table)
 {
-    // Check for config file and entry correctness
-    auto config_table = oat::config::getConfigTable(vm);
-    oat::config::checkKeys(config_keys_, config_table);
-
 #ifdef HAVE_CUDA
     // GPU index
     size_t index = 0;
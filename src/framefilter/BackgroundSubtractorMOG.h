@@ -47,10 +47,12 @@ public:
                             const std::string &frame_sink_address);
 
     void appendOptions(po::options_description &opts) override;
-    void configure(const po::variables_map &vm) override;
 
 private:
 
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+
     /**
      * Apply background subtraction.
      * @param frame unfiltered frame
@@ -0,0 +1,184 @@
+//******************************************************************************
+//* File:   BackgroundSubtractorSigmaDelta.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "BackgroundSubtractorSigmaDelta.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cpptoml.h>
+#include <opencv2/core.hpp>
+
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "BackgroundKernel.h"
+
+namespace oat {
+
+BackgroundSubtractorSigmaDelta::BackgroundSubtractorSigmaDelta(
+        const std::string &frame_source_address,
+        const std::string &frame_sink_address)
+: FrameFilter(frame_source_address, frame_sink_address)
+{
+    // Nothing
+}
+
+void BackgroundSubtractorSigmaDelta::appendOptions(po::options_description &opts)
+{
+    // Accepts a config file
+    FrameFilter::appendOptions(opts);
+
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("adaptation-coeff,a", po::value<double>(),
+         "Value, 0 to 1.0, specifying how quickly the background and variance "
+         "estimates follow the scene. 1.0 moves them by one intensity level "
+         "per frame. Default is 0, specifying no adaptation: the first frame "
+         "is the background.")
+        ("variance-gain", po::value<int>(),
+         "Integer, 1 to 16, multiple of the background difference that the "
+         "variance estimate follows. Larger values need larger or more "
+         "persistent changes to mark a pixel as foreground. Default is 2.")
+        ("variance-range", po::value<std::string>(),
+         "Array of ints between 0 and 255, [min,max], bounding the variance "
+         "estimate. min is the smallest difference from the background that "
+         "can be foreground. Default is [10,255].")
+        ;
+
+    opts.add(local_opts);
+
+    // Return valid keys
+    for (auto &o: local_opts.options())
+        config_keys_.push_back(o->long_name());
+}
+
+void BackgroundSubtractorSigmaDelta::configureFilter(
+        const po::variables_map &vm, const config::OptionTable &config_table)
+{
+    // Learning coefficient
+    double alpha = 0.0;
+    oat::config::getNumericValue<double>(vm, config_table, "adaptation-coeff", alpha, 0.0, 1.0);
+    step_ = static_cast<uint16_t>(std::lround(alpha * (1 << kernel::BACKGROUND_FRAC_BITS)));
+
+    // Variance gain
+    int gain = gain_;
+    oat::config::getNumericValue<int>(vm, config_table, "variance-gain", gain, 1, 16);
+    gain_ = static_cast<uint16_t>(gain);
+
+    // Variance bounds
+    std::vector<int> v;
+    if (oat::config::getArray<int, 2>(vm, config_table, "variance-range", v)) {
+
+        if (v[0] < 0 || v[0] > 255 || v[1] < 0 || v[1] > 255 || v[0] > v[1])
+           throw std::runtime_error("Values of variance-range should be "
+                                    "between 0 and 255 and increasing.");
+
+        variance_min_ = static_cast<uint16_t>(v[0] << kernel::BACKGROUND_FRAC_BITS);
+        variance_max_ = static_cast<uint16_t>(v[1] << kernel::BACKGROUND_FRAC_BITS);
+    }
+}
+
+void BackgroundSubtractorSigmaDelta::setBackgroundImage(const cv::Mat &frame)
+{
+    if (frame.depth() != CV_8U || (frame.channels() != 1 && frame.channels() != 3))
+        throw std::runtime_error("Sigma-delta segmentation requires 8-bit "
+                                 "frames with 1 or 3 channels.");
+
+    frame.convertTo(background_, CV_16U, 1 << kernel::BACKGROUND_FRAC_BITS);
+    variance_.create(frame.rows, frame.cols, CV_16UC1);
+    variance_.setTo(cv::Scalar(variance_min_));
+    background_set_ = true;
+}
+
+void BackgroundSubtractorSigmaDelta::filter(cv::Mat &frame)
+{
+    if (!background_set_)
+        setBackgroundImage(frame);
+
+    segment(frame, frame, cv::Range(0, frame.rows));
+}
+
+void BackgroundSubtractorSigmaDelta::filter(const oat::Frame &in, oat::Frame &out)
+{
+    if (!background_set_)
+        setBackgroundImage(in);
+
+    segment(in, out, cv::Range(0, in.rows));
+}
+
+FrameFilter::Bands BackgroundSubtractorSigmaDelta::bands() const
+{
+    // The first frame initialises the model and must be seen whole
+    return background_set_ ? Bands::POINTWISE : Bands::NONE;
+}
+
+void BackgroundSubtractorSigmaDelta::filterBand(const oat::Frame &in,
+                                                oat::Frame &out,
+                                                const cv::Range &rows)
+{
+    segment(in, out, rows);
+}
+
+void BackgroundSubtractorSigmaDelta::segment(const cv::Mat &in,
+                                             cv::Mat &out,
+                                             const cv::Range &rows)
+{
+    if (in.size() != variance_.size() || in.type() != CV_MAKETYPE(CV_8U, background_.channels()))
+        throw std::runtime_error("Frame size or type changed.");
+
+    // 3-channel rows are segmented in a single pass
+    if (in.channels() == 3) {
+        for (int r = rows.start; r < rows.end; r++)
+            kernel::sigmaDeltaSegment3(in.ptr(r),
+                                       background_.ptr<uint16_t>(r),
+                                       variance_.ptr<uint16_t>(r),
+                                       out.ptr(r),
+                                       in.cols,
+                                       step_,
+                                       gain_,
+                                       variance_min_,
+                                       variance_max_);
+        return;
+    }
+
+    // Differences, then foreground mask, of one row. Needed because out may
+    // be in.
+    std::vector<uint8_t> diff(in.cols);
+
+    for (int r = rows.start; r < rows.end; r++) {
+
+        kernel::sigmaDelta(in.ptr(r), background_.ptr<uint16_t>(r), diff.data(), in.cols, step_);
+
+        kernel::sigmaDeltaVariance(diff.data(),
+                                   variance_.ptr<uint16_t>(r),
+                                   diff.data(),
+                                   in.cols,
+                                   step_,
+                                   gain_,
+                                   variance_min_,
+                                   variance_max_);
+
+        kernel::maskPixels(in.ptr(r), diff.data(), out.ptr(r), in.cols, 1);
+    }
+}
+
+} /* namespace oat */
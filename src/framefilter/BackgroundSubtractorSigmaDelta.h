@@ -0,0 +1,100 @@
+//******************************************************************************
+//* File:   BackgroundSubtractorSigmaDelta.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BACKGROUNDSUBTRACTORSIGMADELTA_H
+#define	OAT_BACKGROUNDSUBTRACTORSIGMADELTA_H
+
+#include <cstdint>
+
+#include "FrameFilter.h"
+
+namespace oat {
+
+/**
+ * A sigma-delta background segmenter.
+ */
+class BackgroundSubtractorSigmaDelta : public FrameFilter {
+public:
+
+    /**
+     * @brief A sigma-delta background segmenter. Keeps a running estimate of
+     * the background and of the per-pixel temporal variance using integer
+     * increments, which approximates a running median. Pixels that differ
+     * from the background by more than their variance estimate are
+     * foreground and left unchanged. All other pixels are set to 0. A fast
+     * CPU alternative to the mog filter.
+     * @param frame_source_address raw frame source address
+     * @param frame_sink_address filtered frame sink address
+     */
+    BackgroundSubtractorSigmaDelta(const std::string &frame_souce_address,
+                                   const std::string &frame_sink_address);
+
+    void appendOptions(po::options_description &opts) override;
+
+private:
+
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+
+    void filter(cv::Mat &frame) override;
+    void filter(const oat::Frame &in, oat::Frame &out) override;
+
+    /**
+     * Segment a band of rows. Only possible once the background model has
+     * been initialised from the first frame.
+     */
+    Bands bands(void) const override;
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+
+    // Initialise the background model from a frame
+    void setBackgroundImage(const cv::Mat &frame);
+
+    /**
+     * Update the background model and zero background pixels for a range of
+     * rows.
+     * @param in Unfiltered frame
+     * @param out Filtered frame. May be the same as in.
+     * @param rows Rows to filter
+     */
+    void segment(const cv::Mat &in, cv::Mat &out, const cv::Range &rows);
+
+    // Has the background model been initialised?
+    bool background_set_ {false};
+
+    // Background estimate of each sample, and variance estimate of each
+    // pixel, in 8.8 fixed-point
+    cv::Mat background_;
+    cv::Mat variance_;
+
+    // Largest per-frame change of the background and variance, 8.8
+    // fixed-point
+    uint16_t step_ {0};
+
+    // Multiple of the background difference tracked by the variance
+    uint16_t gain_ {2};
+
+    // Variance bounds, 8.8 fixed-point
+    uint16_t variance_min_ {10 << 8};
+    uint16_t variance_max_ {255 << 8};
+};
+
+}      /* namespace oat */
+#endif /* OAT_BACKGROUNDSUBTRACTORSIGMADELTA_H */
@@ -0,0 +1,102 @@
+//******************************************************************************
+//* File:   BandPool.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "BandPool.h"
+
+namespace oat {
+
+BandPool::BandPool(size_t threads)
+{
+    for (size_t i = 1; i < threads; i++)
+        workers_.emplace_back(&BandPool::work, this);
+}
+
+BandPool::~BandPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        quit_ = true;
+    }
+    start_cv_.notify_all();
+
+    for (auto &w : workers_)
+        w.join();
+}
+
+void BandPool::run(size_t n, const std::function<void(size_t)> &job)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        job_ = &job;
+        pieces_ = n;
+        next_ = 0;
+        error_ = nullptr;
+        busy_ = workers_.size();
+        generation_++;
+    }
+    start_cv_.notify_all();
+
+    drain();
+
+    // Wait for workers to finish their last piece. The job must outlive
+    // every call into it.
+    std::unique_lock<std::mutex> lk(m_);
+    done_cv_.wait(lk, [this] { return busy_ == 0; });
+    job_ = nullptr;
+
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+void BandPool::work()
+{
+    uint64_t seen = 0;
+
+    for (;;) {
+
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            start_cv_.wait(lk, [&] { return quit_ || generation_ != seen; });
+            if (quit_)
+                return;
+            seen = generation_;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lk(m_);
+        if (--busy_ == 0)
+            done_cv_.notify_one();
+    }
+}
+
+void BandPool::drain()
+{
+    for (size_t i = next_++; i < pieces_; i = next_++) {
+        try {
+            (*job_)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lk(m_);
+            if (!error_)
+                error_ = std::current_exception();
+        }
+    }
+}
+
+} /* namespace oat */
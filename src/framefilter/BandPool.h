@@ -0,0 +1,91 @@
+//******************************************************************************
+//* File:   BandPool.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BANDPOOL_H
+#define	OAT_BANDPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace oat {
+
+/**
+ * Persistent worker threads that split a job into numbered pieces. Used to
+ * filter the row bands of a frame in parallel without creating threads for
+ * each frame.
+ */
+class BandPool {
+public:
+
+    /**
+     * @brief Persistent worker pool.
+     * @param threads Total number of threads, including the one calling
+     * run(). threads - 1 workers are started.
+     */
+    explicit BandPool(size_t threads);
+    ~BandPool();
+
+    BandPool(const BandPool &) = delete;
+    BandPool &operator=(const BandPool &) = delete;
+
+    /**
+     * @brief Call job(0) through job(n - 1), in no particular order and
+     * spread across all threads, then return. The calling thread takes part.
+     * The first exception thrown by a job is rethrown once every job has
+     * finished.
+     * @param n Number of pieces
+     * @param job Function to call on each piece index
+     */
+    void run(size_t n, const std::function<void(size_t)> &job);
+
+    /**
+     * @brief Get the total number of threads, including the caller of run().
+     */
+    size_t threads(void) const { return workers_.size() + 1; }
+
+private:
+
+    void work(void);
+    void drain(void);
+
+    std::vector<std::thread> workers_;
+
+    // Current job
+    const std::function<void(size_t)> *job_ {nullptr};
+    size_t pieces_ {0};
+    std::atomic<size_t> next_ {0};
+    std::exception_ptr error_;
+
+    // Job hand-off
+    std::mutex m_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ {0};
+    size_t busy_ {0};
+    bool quit_ {false};
+};
+
+}      /* namespace oat */
+#endif /* OAT_BANDPOOL_H */
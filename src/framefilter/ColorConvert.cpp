@@ -61,12 +61,9 @@ void ColorConvert::appendOptions(po::options_description &opts)
         config_keys_.push_back(o->long_name());
 }
 
-void ColorConvert::configure(const po::variables_map &vm)
+void ColorConvert::configureFilter(const po::variables_map &vm,
+                                     const config::OptionTable &config_table)
 {
-    // Check for config file and entry correctness
-    auto config_table = oat::config::getConfigTable(vm);
-    oat::config::checkKeys(config_keys_, config_table);
-
     // Pixel color to convert to
     std::string col;
     if (oat::config::getValue<std::string>(
@@ -75,38 +72,27 @@ void ColorConvert::configure(const po::variables_map &vm)
     }
 }
 
-void ColorConvert::connectToNode()
+oat::FrameParams ColorConvert::outputParameters(const oat::FrameParams &in)
 {
-    // Establish our a slot in the source node
-    frame_source_.touch(frame_source_address_);
-
-    // Wait for synchronous start with sink when it binds its node
-    frame_source_.connect();
-
-    // Get frame meta data to format sink
-    auto frame_parameters = frame_source_.parameters();
-
     // Get the color conversion code
-    conversion_code_ = oat::color_conv_code(frame_parameters.color, color_);
+    conversion_code_ = oat::color_conv_code(in.color, color_);
 
     // If there is no conversion being done, throw
     if (conversion_code_ == -1) {
-        throw std::runtime_error("Nothing to be done for " + color_str(frame_parameters.color)
+        throw std::runtime_error("Nothing to be done for " + color_str(in.color)
                                  + " to "
                                  + color_str(color_)
                                  + " conversion.");
     }
 
-    // Bind to sink node and create a shared frame
     // Because this changes the color, it might change the size and type of
     // frame
-    size_t bytes = frame_parameters.rows * frame_parameters.cols
-                   * oat::color_bytes(color_);
-    frame_sink_.bind(frame_sink_address_, bytes);
-    shared_frame_ = frame_sink_.retrieve(frame_parameters.rows,
-                                         frame_parameters.cols,
-                                         oat::cv_type(color_),
-                                         color_);
+    oat::FrameParams out = in;
+    out.type = oat::cv_type(color_);
+    out.color = color_;
+    out.bytes = in.rows * in.cols * oat::color_bytes(color_);
+
+    return out;
 }
 
 void ColorConvert::filter(cv::Mat &frame)
@@ -117,5 +103,25 @@ void ColorConvert::filter(cv::Mat &frame)
     static_cast<oat::Frame &>(frame).set_color(color_);
 }
 
+void ColorConvert::filter(const oat::Frame &in, oat::Frame &out)
+{
+    // Convert directly into the shared frame, which was allocated with the
+    // output color's type
+    cv::cvtColor(in, out, conversion_code_);
+}
+
+void ColorConvert::filterBand(const oat::Frame &in,
+                              oat::Frame &out,
+                              const cv::Range &rows)
+{
+    // cvtColor does not promise to work in place
+    cv::Mat src = in.rowRange(rows);
+    cv::Mat dst = out.rowRange(rows);
+    if (src.data == dst.data)
+        src = src.clone();
+
+    cv::cvtColor(src, dst, conversion_code_);
+}
+
 } /* namespace oat */
 
@@ -39,12 +39,18 @@ public:
     ColorConvert(const std::string &frame_souce_address,
                  const std::string &frame_sink_address);
 
-    void connectToNode(void) override;
     void appendOptions(po::options_description &opts) override;
-    void configure(const po::variables_map &vm) override;
 
 private:
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+    oat::FrameParams outputParameters(const oat::FrameParams &in) override;
     void filter(cv::Mat &frame) override;
+    void filter(const oat::Frame &in, oat::Frame &out) override;
+    Bands bands(void) const override { return Bands::POINTWISE; }
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
 
     int conversion_code_;
     oat::PixelColor color_;
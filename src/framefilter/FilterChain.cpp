@@ -0,0 +1,191 @@
+//******************************************************************************
+//* File:   FilterChain.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "FilterChain.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "BackgroundSubtractor.h"
+#include "BackgroundSubtractorMOG.h"
+#include "BackgroundSubtractorSigmaDelta.h"
+#include "ColorConvert.h"
+#include "FrameMasker.h"
+#include "Resizer.h"
+#include "Threshold.h"
+#include "Undistorter.h"
+
+namespace oat {
+
+namespace {
+
+FrameFilter *makeStage(const std::string &type,
+                       const std::string &source,
+                       const std::string &sink)
+{
+    if (type == "bsub") return new BackgroundSubtractor(source, sink);
+    if (type == "mask") return new FrameMasker(source, sink);
+    if (type == "mog") return new BackgroundSubtractorMOG(source, sink);
+    if (type == "undistort") return new Undistorter(source, sink);
+    if (type == "col") return new ColorConvert(source, sink);
+    if (type == "thresh") return new Threshold(source, sink);
+    if (type == "sigma") return new BackgroundSubtractorSigmaDelta(source, sink);
+    if (type == "resize") return new Resizer(source, sink);
+
+    throw std::runtime_error("Invalid TYPE '" + type + "' in filter chain.");
+}
+
+bool sameFormat(const oat::FrameParams &a, const oat::FrameParams &b)
+{
+    return a.rows == b.rows && a.cols == b.cols && a.type == b.type
+           && a.color == b.color;
+}
+
+} /* namespace */
+
+FilterChain::FilterChain(const std::string &frame_source_address,
+                         const std::string &frame_sink_address,
+                         const std::string &types)
+: FrameFilter(frame_source_address, frame_sink_address)
+{
+    std::istringstream ss(types);
+    std::string t;
+    while (std::getline(ss, t, ',')) {
+        types_.push_back(t);
+        stages_.emplace_back(
+            makeStage(t, frame_source_address, frame_sink_address));
+    }
+
+    if (stages_.empty())
+        throw std::runtime_error("Filter chain is empty.");
+}
+
+void FilterChain::appendOptions(po::options_description &opts)
+{
+    // Accepts a config file
+    FrameFilter::appendOptions(opts);
+
+    // Each stage's options. Options shared by several stages apply to all
+    // of them.
+    for (auto &s : stages_) {
+
+        po::options_description stage_opts;
+        s->appendOptions(stage_opts);
+
+        for (auto &o : stage_opts.options())
+            if (!opts.find_nothrow(o->long_name(), false))
+                opts.add(o);
+    }
+
+    // Each stage is configured from a table named after its TYPE
+    config_keys_ = types_;
+}
+
+void FilterChain::configureFilter(const po::variables_map &vm,
+                                  const config::OptionTable &config_table)
+{
+    for (size_t i = 0; i < stages_.size(); i++) {
+
+        auto stage_table = cpptoml::make_table();
+        oat::config::getTable(config_table, types_[i], stage_table);
+        oat::config::checkKeys(stages_[i]->config_keys_, stage_table);
+
+        stages_[i]->configureFilter(vm, stage_table);
+    }
+}
+
+oat::FrameParams FilterChain::outputParameters(const oat::FrameParams &in)
+{
+    auto p = stages_[0]->outputParameters(in);
+    const auto first = p;
+    same_format_ = sameFormat(in, p);
+
+    for (size_t i = 1; i < stages_.size(); i++) {
+        const auto next = stages_[i]->outputParameters(p);
+        same_format_ = same_format_ && sameFormat(p, next);
+        p = next;
+    }
+
+    first_writes_out_ = sameFormat(first, p);
+
+    return p;
+}
+
+void FilterChain::mapPixels(oat::Sample &sample) const
+{
+    for (auto &s : stages_)
+        s->mapPixels(sample);
+}
+
+void FilterChain::filter(cv::Mat &frame)
+{
+    for (auto &s : stages_)
+        s->filter(frame);
+}
+
+void FilterChain::filter(const oat::Frame &in, oat::Frame &out)
+{
+    // A later stage changes the format, so the output frame cannot hold
+    // intermediate results. Filter a copy instead.
+    if (!first_writes_out_) {
+        FrameFilter::filter(in, out);
+        return;
+    }
+
+    // The first stage reads the input and writes the output, then the rest
+    // work in place
+    stages_[0]->filter(in, out);
+
+    oat::Frame frame = out;
+    for (size_t i = 1; i < stages_.size(); i++)
+        stages_[i]->filter(frame);
+
+    // Filters that produce a new matrix rather than working in place
+    if (frame.data != out.data)
+        frame.copyTo(out);
+}
+
+FrameFilter::Bands FilterChain::bands() const
+{
+    if (!same_format_)
+        return Bands::NONE;
+
+    const auto first = stages_[0]->bands();
+    if (first == Bands::NONE)
+        return Bands::NONE;
+
+    // Later stages filter the output band in place
+    for (size_t i = 1; i < stages_.size(); i++)
+        if (stages_[i]->bands() != Bands::POINTWISE)
+            return Bands::NONE;
+
+    return first;
+}
+
+void FilterChain::filterBand(const oat::Frame &in,
+                             oat::Frame &out,
+                             const cv::Range &rows)
+{
+    stages_[0]->filterBand(in, out, rows);
+
+    for (size_t i = 1; i < stages_.size(); i++)
+        stages_[i]->filterBand(out, out, rows);
+}
+
+} /* namespace oat */
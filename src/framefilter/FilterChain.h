@@ -0,0 +1,84 @@
+//******************************************************************************
+//* File:   FilterChain.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_FILTERCHAIN_H
+#define	OAT_FILTERCHAIN_H
+
+#include "FrameFilter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace oat {
+
+/**
+ * An ordered list of frame filters sharing one SOURCE and one SINK.
+ */
+class FilterChain : public FrameFilter {
+public:
+
+    /**
+     * @brief Apply several filters to each frame within a single component.
+     * Frames are read from the SOURCE and written to the SINK once, and each
+     * filter works in place on the shared frame in turn.
+     *
+     * @param frame_source_address raw frame source address
+     * @param frame_sink_address filtered frame sink address
+     * @param types Comma separated filter TYPEs, in order (e.g. col,mask,bsub)
+     */
+    FilterChain(const std::string &frame_source_address,
+                const std::string &frame_sink_address,
+                const std::string &types);
+
+    void appendOptions(po::options_description &opts) override;
+
+private:
+
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+    oat::FrameParams outputParameters(const oat::FrameParams &in) override;
+    void mapPixels(oat::Sample &sample) const override;
+    void filter(cv::Mat &frame) override;
+    void filter(const oat::Frame &in, oat::Frame &out) override;
+
+    /**
+     * Run every stage over one band of rows before moving to the next band,
+     * so the band stays in cache. Only possible if every stage supports row
+     * bands and keeps the frame format, and only the first stage needs its
+     * input and output to be distinct.
+     */
+    Bands bands(void) const override;
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+
+    std::vector<std::string> types_;
+    std::vector<std::unique_ptr<FrameFilter>> stages_;
+
+    // The first stage writes its result straight into the shared output
+    // frame. Only possible if no later stage changes the frame format.
+    bool first_writes_out_ {false};
+
+    // No stage changes the frame format
+    bool same_format_ {false};
+};
+
+}      /* namespace oat */
+#endif /* OAT_FILTERCHAIN_H */
@@ -19,10 +19,16 @@
 
 #include "FrameFilter.h"
 
+#include <algorithm>
+#include <stdexcept>
 #include <string>
 
 namespace oat {
 
+// Approximate input bytes per row band. Small enough that a band and its
+// output stay in a core's L2 cache while every filter stage touches it.
+static constexpr size_t BAND_BYTES {1 << 16};
+
 FrameFilter::FrameFilter(const std::string &frame_source_address,
                          const std::string &frame_sink_address)
 : name_("framefilt[" + frame_source_address + "->" + frame_sink_address + "]")
@@ -39,9 +45,36 @@ void FrameFilter::appendOptions(po::options_description &opts)
         ("config,c", po::value<std::vector<std::string> >()->multitoken(),
         "Configuration file/key pair.\n"
         "e.g. 'config.toml mykey'")
+        ("threads", po::value<size_t>(),
+         "Number of threads used to filter each frame. Filters that support "
+         "it split frames into bands of rows that are processed in parallel. "
+         "Defaults to 1.")
         ;
 }
 
+void FrameFilter::configure(const po::variables_map &vm)
+{
+    // Check for config file and entry correctness
+    auto config_table = oat::config::getConfigTable(vm);
+    auto keys = config_keys_;
+    keys.push_back("threads");
+    oat::config::checkKeys(keys, config_table);
+
+    // Row band workers
+    size_t threads = 1;
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "threads", threads, 1);
+    if (threads > 1)
+        pool_.reset(new BandPool(threads));
+
+    configureFilter(vm, config_table);
+}
+
+oat::FrameParams FrameFilter::outputParameters(const oat::FrameParams &in)
+{
+    return in;
+}
+
 void FrameFilter::connectToNode()
 {
     // Establish our a slot in the source node
@@ -51,55 +84,88 @@ void FrameFilter::connectToNode()
     frame_source_.connect();
 
     // Get frame meta data to format sink
-    auto frame_parameters = frame_source_.parameters();
+    const auto source_parameters = frame_source_.parameters();
+    auto frame_parameters = outputParameters(source_parameters);
+
+    // Rows per band, based on the wider of the input and output rows
+    const size_t row_bytes = std::max(source_parameters.bytes,
+                                      frame_parameters.bytes)
+                             / std::max<size_t>(source_parameters.rows, 1);
+    band_rows_ = std::max<size_t>(BAND_BYTES / std::max<size_t>(row_bytes, 1), 1);
 
     // Bind to sink node and create a shared frame
     frame_sink_.bind(frame_sink_address_, frame_parameters.bytes);
-    shared_frame_ = frame_sink_.retrieve(frame_parameters.rows,
-                                         frame_parameters.cols,
-                                         frame_parameters.type,
-                                         frame_parameters.color);
+    frame_sink_.retrieve(frame_parameters.rows,
+                         frame_parameters.cols,
+                         frame_parameters.type,
+                         frame_parameters.color);
 }
 
 bool FrameFilter::process()
 {
-    oat::Frame internal_frame;
-
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sink to write to node
-    if (frame_source_.wait() == oat::NodeState::END)
+    // Wait for sink to write to node and lease the shared frame
+    auto in = frame_source_.acquire();
+    if (!in)
         return true;
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame);
+    // Wait for sources to read and lease the next shared frame
+    auto out = frame_sink_.acquire();
+
+    // Filter straight from one node into the next
+    filterFrame(*in, *out);
+    auto sample = in->sample();
+    mapPixels(sample);
+    out->set_sample(sample);
+    out->stampHop();
 
     // Tell sink it can continue
-    frame_source_.post();
+    in.release();
+
+    // Tell sources there is new data
+    out.release();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Filter internal frame
-    filter(internal_frame);
-
-    // START CRITICAL SECTION //
-    ////////////////////////////
+    // Sink was not at END state
+    return false;
+}
 
-    // Wait for sources to read
-    frame_sink_.wait();
+void FrameFilter::filter(const oat::Frame &in, oat::Frame &out)
+{
+    oat::Frame frame = out;
+    in.copyTo(frame);
 
-    internal_frame.copyTo(shared_frame_);
+    filter(frame);
 
-    // Tell sources there is new data
-    frame_sink_.post();
+    // Filters that produce a new matrix rather than working in place
+    if (frame.data != out.data)
+        frame.copyTo(out);
+}
 
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
+void FrameFilter::filterBand(const oat::Frame &, oat::Frame &, const cv::Range &)
+{
+    throw std::runtime_error(name_ + " cannot filter row bands.");
+}
 
-    // Sink was not at END state
-    return false;
+void FrameFilter::filterFrame(const oat::Frame &in, oat::Frame &out)
+{
+    if (!pool_ || bands() == Bands::NONE) {
+        filter(in, out);
+        return;
+    }
+
+    // Bands are of output rows, which filters that crop have fewer of
+    const size_t rows = out.rows;
+    const size_t n = (rows + band_rows_ - 1) / band_rows_;
+
+    pool_->run(n, [&](size_t i) {
+        const size_t start = i * band_rows_;
+        filterBand(in, out, cv::Range(start, std::min(start + band_rows_, rows)));
+    });
 }
 
 } /* namespace oat */
@@ -20,6 +20,7 @@
 #ifndef OAT_FRAMEFILT_H
 #define	OAT_FRAMEFILT_H
 
+#include <memory>
 #include <string>
 
 #include <boost/program_options.hpp>
@@ -27,10 +28,13 @@
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "BandPool.h"
 
 namespace oat {
 
-class ColorConvert; // Forward decl.
+class FilterChain; // Forward decl.
 namespace po = boost::program_options;
 
 /**
@@ -38,7 +42,7 @@ namespace po = boost::program_options;
  * All concrete frame filter types implement this ABC.
  */
 class FrameFilter {
-    friend ColorConvert;
+    friend FilterChain;
 public:
 
     /**
@@ -61,7 +65,7 @@ public:
      * @brief Configure component parameters.
      * @param vm Previously parsed program option value map.
      */
-    virtual void configure(const po::variables_map &vm) = 0;
+    void configure(const po::variables_map &vm);
 
     /**
      * @brief Connect to shared memory node.
@@ -84,12 +88,50 @@ public:
 
 protected:
 
+    /**
+     * @brief How a filter can be split into horizontal bands of rows that
+     * are filtered in parallel.
+     */
+    enum class Bands {
+        NONE,         //!< Whole frames only
+        POINTWISE,    //!< Output rows depend only on the same input rows.
+                      //!< Input and output may be the same frame.
+        NEIGHBOURHOOD //!< Output rows depend on other input rows. Input and
+                      //!< output are always distinct frames.
+    };
+
     // Filter name
     const std::string name_;
 
     // List of allowed configuration options
     std::vector<std::string> config_keys_;
 
+    /**
+     * @brief Configure filter parameters. Called by configure() once the
+     * configuration table has been checked against config_keys_.
+     * @param vm Previously parsed program option value map.
+     * @param config_table Configuration table. Empty if none was supplied.
+     */
+    virtual void configureFilter(const po::variables_map &vm,
+                                 const config::OptionTable &config_table) = 0;
+
+    /**
+     * @brief Get the format of filtered frames. Called once, when connecting
+     * to the SOURCE. Override in filters that change the frame format.
+     * @param in Format of SOURCE frames
+     * @return Format of SINK frames
+     */
+    virtual oat::FrameParams outputParameters(const oat::FrameParams &in);
+
+    /**
+     * @brief Record how the pixels of filtered frames map onto those of
+     * SOURCE frames. Called for every frame. Override in filters that crop
+     * or resample frames.
+     * @param sample Sample of the filtered frame, copied from the SOURCE
+     * frame
+     */
+    virtual void mapPixels(oat::Sample &) const { }
+
     /**
      * Perform frame filtering. Override to implement filtering operation in
      * derived classes.
@@ -97,8 +139,50 @@ protected:
      */
     virtual void filter(cv::Mat &frame) = 0;
 
+    /**
+     * Filter a frame into the shared frame that will be published. The
+     * default implementation copies the input into the output and filters it
+     * in place. Override to write the result directly into the output when
+     * the filtering operation allows it, which avoids the copy.
+     * @param in Read-only input frame
+     * @param out Shared output frame
+     */
+    virtual void filter(const oat::Frame &in, oat::Frame &out);
+
+    /**
+     * Declare whether this filter can work on row bands. Checked for every
+     * frame, so it may change at run time.
+     * @return Band parallelism supported by the filter in its current state
+     */
+    virtual Bands bands(void) const { return Bands::NONE; }
+
+    /**
+     * Filter one band of rows into the shared output frame. Called
+     * concurrently on disjoint bands when bands() is not Bands::NONE and more
+     * than one thread has been requested. The input frame may be the output
+     * frame only for Bands::POINTWISE filters.
+     * @param in Read-only input frame
+     * @param out Shared output frame. Only the given rows may be written.
+     * @param rows Band of output rows to filter
+     */
+    virtual void filterBand(const oat::Frame &in,
+                            oat::Frame &out,
+                            const cv::Range &rows);
+
 private:
 
+    /**
+     * Filter a frame, splitting it into row bands across the worker pool if
+     * the filter allows it.
+     * @param in Read-only input frame
+     * @param out Shared output frame
+     */
+    void filterFrame(const oat::Frame &in, oat::Frame &out);
+
+    // Row band workers. Null if filtering is single threaded.
+    std::unique_ptr<BandPool> pool_;
+    size_t band_rows_ {0};
+
     // Frame source
     const std::string frame_source_address_;
     oat::Source<oat::Frame> frame_source_;
@@ -106,9 +190,6 @@ private:
     // Frame sink
     const std::string frame_sink_address_;
     oat::Sink<oat::Frame> frame_sink_;
-
-    // Currently acquired, shared frame
-    oat::Frame shared_frame_;
 };
 
 }      /* namespace oat */
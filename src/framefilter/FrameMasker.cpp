@@ -19,6 +19,10 @@
 
 #include "FrameMasker.h"
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+
 #include <cpptoml.h>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgproc.hpp>
@@ -50,6 +54,11 @@ void FrameMasker::appendOptions(po::options_description &opts)
          "pixels with indices corresponding to non-zero value pixels in the mask "
          "image will be unaffected. Others will be set to zero. This image must "
          "have the same dimensions as frames from SOURCE.")
+        ("crop",
+         "If specified, publish only the bounding box of the non-zero mask "
+         "pixels rather than whole frames. Pixel coordinates in the published "
+         "frames are relative to the top-left corner of this box, which is "
+         "recorded with each frame.")
         ;
 
     opts.add(local_opts);
@@ -59,12 +68,9 @@ void FrameMasker::appendOptions(po::options_description &opts)
         config_keys_.push_back(o->long_name());
 }
 
-void FrameMasker::configure(const po::variables_map &vm)
+void FrameMasker::configureFilter(const po::variables_map &vm,
+                                    const config::OptionTable &config_table)
 {
-    // Check for config file and entry correctness
-    auto config_table = oat::config::getConfigTable(vm);
-    oat::config::checkKeys(config_keys_, config_table);
-
     // Background image path
     std::string img_path;
     if (oat::config::getValue(vm, config_table, "mask", img_path, true)) {
@@ -75,13 +81,144 @@ void FrameMasker::configure(const po::variables_map &vm)
             throw (std::runtime_error("File \"" + img_path + "\" could not be read."));
 
         mask_set_ = true;
+
+        // Find the kept spans of each row once, so that frames are only
+        // touched where they need to be zeroed or copied
+        kept_.clear();
+        row_spans_.assign(1, 0);
+        int left = roi_mask_.cols, right = 0, top = roi_mask_.rows, bottom = 0;
+
+        for (int r = 0; r < roi_mask_.rows; r++) {
+
+            const uchar *m = roi_mask_.ptr(r);
+            int c = 0;
+
+            while (c < roi_mask_.cols) {
+
+                while (c < roi_mask_.cols && m[c] == 0)
+                    c++;
+                if (c == roi_mask_.cols)
+                    break;
+
+                const int start = c;
+                while (c < roi_mask_.cols && m[c] != 0)
+                    c++;
+                kept_.emplace_back(start, c);
+
+                left = std::min(left, start);
+                right = std::max(right, c);
+                top = std::min(top, r);
+                bottom = r + 1;
+            }
+
+            row_spans_.push_back(kept_.size());
+        }
+
+        bounds_ = kept_.empty() ? cv::Rect()
+                                : cv::Rect(left, top, right - left, bottom - top);
     }
+
+    // Crop to kept pixels
+    oat::config::getValue(vm, config_table, "crop", crop_);
+
+    if (crop_ && kept_.empty())
+        throw std::runtime_error("Cannot crop to an empty mask.");
+}
+
+oat::FrameParams FrameMasker::outputParameters(const oat::FrameParams &in)
+{
+    region_ = cv::Rect(0, 0, in.cols, in.rows);
+
+    if (!mask_set_)
+        return in;
+
+    if (static_cast<size_t>(roi_mask_.rows) != in.rows
+        || static_cast<size_t>(roi_mask_.cols) != in.cols)
+        throw std::runtime_error("Mask image must have the same dimensions "
+                                 "as frames from SOURCE.");
+
+    if (!crop_)
+        return in;
+
+    region_ = bounds_;
+
+    oat::FrameParams out = in;
+    out.rows = region_.height;
+    out.cols = region_.width;
+    out.bytes = in.bytes / (in.rows * in.cols) * out.rows * out.cols;
+
+    return out;
+}
+
+void FrameMasker::mapPixels(oat::Sample &sample) const
+{
+    if (crop_)
+        sample.resample(cv::Point2d(region_.x, region_.y), cv::Point2d(1, 1));
 }
 
 void FrameMasker::filter(cv::Mat &frame)
 {
-    if (mask_set_)
-        frame.setTo(0, roi_mask_ == 0);
+    if (!crop_) {
+        mask(frame, frame, cv::Range(0, frame.rows));
+        return;
+    }
+
+    cv::Mat cropped(region_.height, region_.width, frame.type());
+    mask(frame, cropped, cv::Range(0, cropped.rows));
+    frame = cropped;
+}
+
+void FrameMasker::filter(const oat::Frame &in, oat::Frame &out)
+{
+    mask(in, out, cv::Range(0, out.rows));
+}
+
+FrameFilter::Bands FrameMasker::bands() const
+{
+    // Cropped output rows come from other input rows
+    return crop_ ? Bands::NEIGHBOURHOOD : Bands::POINTWISE;
+}
+
+void FrameMasker::filterBand(const oat::Frame &in,
+                             oat::Frame &out,
+                             const cv::Range &rows)
+{
+    mask(in, out, rows);
+}
+
+void FrameMasker::mask(const cv::Mat &in, cv::Mat &out, const cv::Range &rows)
+{
+    const size_t elem = in.elemSize();
+    const size_t width = region_.width * elem;
+
+    for (int r = rows.start; r < rows.end; r++) {
+
+        const uchar *src = in.ptr(r + region_.y) + region_.x * elem;
+        uchar *dst = out.ptr(r);
+
+        if (!mask_set_) {
+            if (src != dst)
+                std::memcpy(dst, src, width);
+            continue;
+        }
+
+        // Zero the gaps between kept spans and copy the spans themselves.
+        // memset and memcpy use the widest stores available.
+        size_t x = 0;
+        const int mask_row = r + region_.y;
+        for (size_t k = row_spans_[mask_row]; k < row_spans_[mask_row + 1]; k++) {
+
+            const size_t start = (kept_[k].first - region_.x) * elem;
+            const size_t end = (kept_[k].second - region_.x) * elem;
+
+            std::memset(dst + x, 0, start - x);
+            if (src != dst)
+                std::memcpy(dst + start, src + start, end - start);
+            x = end;
+        }
+
+        std::memset(dst + x, 0, width - x);
+    }
 }
 
 } /* namespace oat */
@@ -20,6 +20,9 @@
 #ifndef OAT_FRAMEMASKER_H
 #define	OAT_FRAMEMASKER_H
 
+#include <utility>
+#include <vector>
+
 #include "FrameFilter.h"
 
 namespace oat {
@@ -43,15 +46,51 @@ public:
                 const std::string &frame_sink_address);
 
     void appendOptions(po::options_description &opts) override;
-    void configure(const po::variables_map &vm) override;
 
 private:
 
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+
+    /**
+     * Check the mask against the SOURCE frame size and, if cropping, shrink
+     * the output frames to the bounding box of the kept pixels.
+     */
+    oat::FrameParams outputParameters(const oat::FrameParams &in) override;
+    void mapPixels(oat::Sample &sample) const override;
+
     void filter(cv::Mat& frame) override;
+    void filter(const oat::Frame &in, oat::Frame &out) override;
+    Bands bands(void) const override;
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+
+    /**
+     * Copy kept pixels and zero the rest for a range of output rows.
+     * @param in Unfiltered frame
+     * @param out Filtered frame. May be the same as in when not cropping.
+     * @param rows Output rows to filter
+     */
+    void mask(const cv::Mat &in, cv::Mat &out, const cv::Range &rows);
 
     // Mask frames with an arbitrary ROI
     bool mask_set_ = false;
     cv::Mat roi_mask_;
+
+    // Column spans, [start, end), of kept (non-zero) mask pixels. The spans
+    // of mask row r are kept_[row_spans_[r]] to kept_[row_spans_[r + 1] - 1].
+    std::vector<std::pair<int, int>> kept_;
+    std::vector<size_t> row_spans_;
+
+    // Bounding box of kept pixels
+    cv::Rect bounds_;
+
+    // Publish only the bounding box of kept pixels
+    bool crop_ {false};
+
+    // Region of SOURCE frames that is published
+    cv::Rect region_;
 };
 
 }      /* namespace oat */
@@ -0,0 +1,183 @@
+//******************************************************************************
+//* File:   Resizer.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "Resizer.h"
+
+#include <cmath>
+#include <string>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/utility/TOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace oat {
+
+Resizer::Resizer(const std::string &frame_source_address,
+                 const std::string &frame_sink_address)
+: FrameFilter(frame_source_address, frame_sink_address)
+{
+    // Nothing
+}
+
+void Resizer::appendOptions(po::options_description &opts)
+{
+    // Accepts a config file
+    FrameFilter::appendOptions(opts);
+
+    // Update CLI options
+    po::options_description local_opts;
+    local_opts.add_options()
+        ("roi,r", po::value<std::string>(),
+         "Array of ints, [x,y,width,height], specifying the region of SOURCE "
+         "frames to keep, in pixels. Defaults to whole frames.")
+        ("factor,s", po::value<double>(),
+         "Downsampling factor, 1 to 64. Integer factors average each "
+         "factor x factor block of pixels, and drop right and bottom edges "
+         "that do not fill a whole block. Other factors use area "
+         "resampling. Defaults to 1.")
+        ;
+
+    opts.add(local_opts);
+
+    // Return valid keys
+    for (auto &o : local_opts.options())
+        config_keys_.push_back(o->long_name());
+}
+
+void Resizer::configureFilter(const po::variables_map &vm,
+                              const config::OptionTable &config_table)
+{
+    // Region of interest
+    std::vector<int> r;
+    if (oat::config::getArray<int, 4>(vm, config_table, "roi", r)) {
+
+        if (r[0] < 0 || r[1] < 0 || r[2] <= 0 || r[3] <= 0)
+            throw std::runtime_error("roi must have a non-negative origin and "
+                                     "a positive width and height.");
+
+        roi_ = cv::Rect(r[0], r[1], r[2], r[3]);
+    }
+
+    // Downsampling factor
+    oat::config::getNumericValue<double>(
+        vm, config_table, "factor", factor_, 1.0, 64.0);
+
+    int_factor_ = factor_ == std::floor(factor_) ? static_cast<int>(factor_) : 0;
+}
+
+oat::FrameParams Resizer::outputParameters(const oat::FrameParams &in)
+{
+    const cv::Rect frame(0, 0, in.cols, in.rows);
+    region_ = roi_.area() > 0 ? roi_ : frame;
+
+    if ((region_ & frame) != region_)
+        throw std::runtime_error("roi must lie within frames from SOURCE.");
+
+    int cols, rows;
+    if (int_factor_ > 0) {
+
+        // Whole blocks only, so that cv::resize can take its integer
+        // factor fast path
+        cols = region_.width / int_factor_;
+        rows = region_.height / int_factor_;
+        region_.width = cols * int_factor_;
+        region_.height = rows * int_factor_;
+
+    } else {
+        cols = static_cast<int>(std::lround(region_.width / factor_));
+        rows = static_cast<int>(std::lround(region_.height / factor_));
+    }
+
+    if (cols == 0 || rows == 0)
+        throw std::runtime_error("Downsampling factor is larger than the "
+                                 "region of SOURCE frames that is kept.");
+
+    // Each output pixel averages a block of input pixels. Its centre is at
+    // the centre of that block.
+    scale_ = cv::Point2d(static_cast<double>(region_.width) / cols,
+                         static_cast<double>(region_.height) / rows);
+    offset_ = cv::Point2d(region_.x + (scale_.x - 1) / 2,
+                          region_.y + (scale_.y - 1) / 2);
+
+    size_ = cv::Size(cols, rows);
+
+    oat::FrameParams out = in;
+    out.rows = rows;
+    out.cols = cols;
+    out.bytes = in.bytes / (in.rows * in.cols) * out.rows * out.cols;
+
+    return out;
+}
+
+void Resizer::mapPixels(oat::Sample &sample) const
+{
+    sample.resample(offset_, scale_);
+}
+
+void Resizer::filter(cv::Mat &frame)
+{
+    cv::Mat resized(size_, frame.type());
+    resize(frame, resized, cv::Range(0, resized.rows));
+    frame = resized;
+}
+
+void Resizer::filter(const oat::Frame &in, oat::Frame &out)
+{
+    resize(in, out, cv::Range(0, out.rows));
+}
+
+FrameFilter::Bands Resizer::bands() const
+{
+    return int_factor_ > 0 ? Bands::NEIGHBOURHOOD : Bands::NONE;
+}
+
+void Resizer::filterBand(const oat::Frame &in,
+                         oat::Frame &out,
+                         const cv::Range &rows)
+{
+    resize(in, out, rows);
+}
+
+void Resizer::resize(const cv::Mat &in, cv::Mat &out, const cv::Range &rows)
+{
+    // Input rows that the output rows are made from. Other factors are
+    // only ever used on whole frames.
+    const cv::Range src_rows
+        = int_factor_ > 0
+          ? cv::Range(rows.start * int_factor_, rows.end * int_factor_)
+          : cv::Range(0, region_.height);
+
+    const cv::Mat src = cv::Mat(in, region_).rowRange(src_rows);
+    cv::Mat dst = out.rowRange(rows);
+
+    // Crop only
+    if (int_factor_ == 1) {
+        src.copyTo(dst);
+        return;
+    }
+
+    // INTER_AREA averages whole blocks of pixels for integer factors, and
+    // weights partially covered pixels by their overlap otherwise
+    cv::resize(src, dst, dst.size(), 0, 0, cv::INTER_AREA);
+}
+
+} /* namespace oat */
@@ -0,0 +1,101 @@
+//******************************************************************************
+//* File:   Resizer.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_RESIZER_H
+#define	OAT_RESIZER_H
+
+#include "FrameFilter.h"
+
+namespace oat {
+
+/**
+ * Frame cropping and downsampling.
+ */
+class Resizer : public FrameFilter {
+public:
+
+    /**
+     * @brief Crop frames to a region of interest and/or downsample them to
+     * reduce the work and bandwidth of later components. The crop offset and
+     * scale are recorded with each frame so that positions detected
+     * downstream can be mapped back to full resolution.
+     *
+     * @param frame_source_address raw frame source address
+     * @param frame_sink_address filtered frame sink address
+     */
+    Resizer(const std::string &frame_source_address,
+            const std::string &frame_sink_address);
+
+    void appendOptions(po::options_description &opts) override;
+
+private:
+
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+
+    /**
+     * Check the region of interest against the SOURCE frame size and size
+     * the output frames.
+     * @param in Format of SOURCE frames
+     * @return Format of SINK frames
+     */
+    oat::FrameParams outputParameters(const oat::FrameParams &in) override;
+    void mapPixels(oat::Sample &sample) const override;
+
+    void filter(cv::Mat &frame) override;
+    void filter(const oat::Frame &in, oat::Frame &out) override;
+
+    /**
+     * Each band of output rows is made from its own band of input rows when
+     * the factor is an integer. Other factors blend input rows across band
+     * boundaries, so whole frames are resampled at once.
+     */
+    Bands bands(void) const override;
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+
+    /**
+     * Crop and resample a range of output rows.
+     * @param in Unfiltered frame
+     * @param out Filtered frame. Never the same as in.
+     * @param rows Output rows to filter
+     */
+    void resize(const cv::Mat &in, cv::Mat &out, const cv::Range &rows);
+
+    // Requested region of SOURCE frames. Empty to keep whole frames.
+    cv::Rect roi_;
+
+    // Downsampling factor
+    double factor_ {1.0};
+    int int_factor_ {0}; // Non-zero if factor_ is an integer
+
+    // Region of SOURCE frames that is resampled, and the size it is
+    // resampled to
+    cv::Rect region_;
+    cv::Size size_;
+
+    // Position of output pixel (0, 0) and size of output pixels in SOURCE
+    // pixels
+    cv::Point2d offset_ {0, 0};
+    cv::Point2d scale_ {1, 1};
+};
+
+}      /* namespace oat */
+#endif /* OAT_RESIZER_H */
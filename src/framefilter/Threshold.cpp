@@ -27,6 +27,8 @@
 #include "../../lib/utility/ProgramOptions.h"
 #include "../../lib/utility/TOMLSanitize.h"
 
+#include "ThresholdKernel.h"
+
 namespace oat {
 
 Threshold::Threshold(const std::string &frame_source_address,
@@ -56,12 +58,9 @@ void Threshold::appendOptions(po::options_description &opts)
         config_keys_.push_back(o->long_name());
 }
 
-void Threshold::configure(const po::variables_map &vm)
+void Threshold::configureFilter(const po::variables_map &vm,
+                                  const config::OptionTable &config_table)
 {
-    // Check for config file and entry correctness
-    auto config_table = oat::config::getConfigTable(vm);
-    oat::config::checkKeys(config_keys_, config_table);
-
     // Intensity
     std::vector<int> i;
     if (oat::config::getArray<int, 2>(vm, config_table, "intensity", i)) {
@@ -74,20 +73,71 @@ void Threshold::configure(const po::variables_map &vm)
     }
 }
 
+oat::FrameParams Threshold::outputParameters(const oat::FrameParams &in)
+{
+    // A plain cv::Mat passed to filter() does not carry its color
+    color_ = in.color;
+    return in;
+}
+
 void Threshold::filter(cv::Mat &frame)
 {
-    cv::Mat grey_frame, thresh_frame;
+    threshold(frame, color_, frame, cv::Range(0, frame.rows));
+}
 
-    auto conversion_code = oat::color_conv_code(
-        static_cast<oat::Frame &>(frame).color(), oat::PIX_GREY);
+void Threshold::filter(const oat::Frame &in, oat::Frame &out)
+{
+    threshold(in, in.color(), out, cv::Range(0, in.rows));
+}
+
+void Threshold::filterBand(const oat::Frame &in,
+                           oat::Frame &out,
+                           const cv::Range &rows)
+{
+    threshold(in, in.color(), out, rows);
+}
+
+void Threshold::threshold(const cv::Mat &in,
+                          const oat::PixelColor color,
+                          cv::Mat &out,
+                          const cv::Range &rows)
+{
+    auto conversion_code = oat::color_conv_code(color, oat::PIX_GREY);
+
+    if (in.depth() == CV_8U && in.isContinuous() && out.isContinuous()) {
+
+        const size_t offset = static_cast<size_t>(rows.start) * in.cols;
+        const size_t n = static_cast<size_t>(rows.end - rows.start) * in.cols;
+
+        if (color == oat::PIX_BGR && in.channels() == 3) {
+            kernel::thresholdBGR(in.ptr() + 3 * offset,
+                                 out.ptr() + 3 * offset,
+                                 n, i_min_, i_max_);
+            return;
+        } else if (conversion_code < 0 && in.channels() == 1) {
+            kernel::thresholdGrey(in.ptr() + offset,
+                                  out.ptr() + offset,
+                                  n, i_min_, i_max_);
+            return;
+        }
+    }
+
+    const cv::Mat src = in.rowRange(rows);
+    cv::Mat dst = out.rowRange(rows);
+    cv::Mat grey_band, thresh_band;
 
     if (conversion_code >= 0)
-        cv::cvtColor(frame, grey_frame, conversion_code);
+        cv::cvtColor(src, grey_band, conversion_code);
     else
-        grey_frame = frame;
+        grey_band = src;
+
+    // Threshold before writing, in case src and dst are the same rows
+    cv::inRange(grey_band, i_min_, i_max_, thresh_band);
+
+    if (src.data != dst.data)
+        src.copyTo(dst);
 
-    cv::inRange(grey_frame, i_min_, i_max_, thresh_frame);
-    frame.setTo(cv::Scalar(0, 0, 0), thresh_frame == 0);
+    dst.setTo(cv::Scalar(0, 0, 0), thresh_band == 0);
 }
 
 } /* namespace oat */
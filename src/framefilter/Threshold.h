@@ -39,15 +39,40 @@ public:
               const std::string &frame_sink_address);
 
     void appendOptions(po::options_description &opts) override;
-    void configure(const po::variables_map &vm) override;
 
 private:
 
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+    oat::FrameParams outputParameters(const oat::FrameParams &in) override;
     void filter(cv::Mat &frame) override;
+    void filter(const oat::Frame &in, oat::Frame &out) override;
+    Bands bands(void) const override { return Bands::POINTWISE; }
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+
+    /**
+     * Zero pixels outside of the intensity passband in a range of rows.
+     * 8-bit BGR and grey frames are converted and tested in a single pass
+     * without intermediate buffers. Other formats go through cv::cvtColor
+     * and cv::inRange.
+     * @param in Unfiltered frame
+     * @param color Pixel color of in
+     * @param out Output frame. May be the same as in.
+     * @param rows Rows to filter
+     */
+    void threshold(const cv::Mat &in,
+                   const oat::PixelColor color,
+                   cv::Mat &out,
+                   const cv::Range &rows);
 
     // Intensity threshold boundaries
     int i_min_ {0};
     int i_max_ {256};
+
+    // Pixel color of SOURCE frames
+    oat::PixelColor color_ {oat::PIX_BGR};
 };
 
 }      /* namespace oat */
@@ -0,0 +1,243 @@
+//******************************************************************************
+//* File:   ThresholdKernel.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "ThresholdKernel.h"
+
+#include <algorithm>
+#include <cstring>
+
+// See BackgroundKernel.cpp
+#if defined(__GNUC__) && defined(__x86_64__)
+#define OAT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace oat {
+namespace kernel {
+
+namespace {
+
+// Fixed-point BGR to grey weights used by cv::cvtColor for 8-bit frames in
+// OpenCV 3.x (yuv_shift = 14). OpenCV 4 and later use 15 fractional bits,
+// which rounds about 0.3% of colours to an adjacent grey level.
+static constexpr int LUMA_SHIFT {14};
+static constexpr int LUMA_B {1868};
+static constexpr int LUMA_G {9617};
+static constexpr int LUMA_R {4899};
+
+inline int luma(const uint8_t *bgr)
+{
+    return (bgr[0] * LUMA_B + bgr[1] * LUMA_G + bgr[2] * LUMA_R
+            + (1 << (LUMA_SHIFT - 1))) >> LUMA_SHIFT;
+}
+
+void thresholdBGRScalar(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi)
+{
+    for (size_t p = 0; p < pixels; p++) {
+        const int y = luma(in + 3 * p);
+        const uint8_t keep = (y >= lo && y <= hi) ? 0xFF : 0;
+        out[3 * p] = in[3 * p] & keep;
+        out[3 * p + 1] = in[3 * p + 1] & keep;
+        out[3 * p + 2] = in[3 * p + 2] & keep;
+    }
+}
+
+void thresholdGreyScalar(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi)
+{
+    for (size_t p = 0; p < pixels; p++)
+        out[p] = (in[p] >= lo && in[p] <= hi) ? in[p] : 0;
+}
+
+#ifdef OAT_X86_KERNELS
+
+// Weighted sum of two 8-bit channels, widened to 16 bits, plus a rounding
+// constant, as 32-bit lanes. Four pixels from the low or high half.
+__attribute__((target("ssse3")))
+inline __m128i lumaPart(__m128i b16, __m128i g16, __m128i r16, bool high)
+{
+    const __m128i bg_w = _mm_setr_epi16(LUMA_B, LUMA_G, LUMA_B, LUMA_G,
+                                        LUMA_B, LUMA_G, LUMA_B, LUMA_G);
+    const __m128i r1_w = _mm_setr_epi16(LUMA_R, 1, LUMA_R, 1, LUMA_R, 1, LUMA_R, 1);
+    const __m128i round = _mm_set1_epi16(1 << (LUMA_SHIFT - 1));
+
+    const __m128i bg = high ? _mm_unpackhi_epi16(b16, g16) : _mm_unpacklo_epi16(b16, g16);
+    const __m128i r1 = high ? _mm_unpackhi_epi16(r16, round) : _mm_unpacklo_epi16(r16, round);
+
+    const __m128i y = _mm_add_epi32(_mm_madd_epi16(bg, bg_w), _mm_madd_epi16(r1, r1_w));
+    return _mm_srai_epi32(y, LUMA_SHIFT);
+}
+
+__attribute__((target("ssse3")))
+void thresholdBGRSSSE3(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi)
+{
+    // Gather one channel of 16 pixels from three 16-byte blocks
+    const __m128i c0a = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i c0b = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i c0c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i c1a = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i c1b = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i c1c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i c2a = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i c2b = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i c2c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+    // Repeat each of 16 mask bytes three times across three blocks
+    const __m128i ea = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+    const __m128i eb = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+    const __m128i ec = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+
+    // Passband as 16-bit lanes. Bounds are clamped by thresholdBGR()
+    const __m128i below = _mm_set1_epi16(static_cast<short>(lo));
+    const __m128i above = _mm_set1_epi16(static_cast<short>(hi));
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+
+        const uint8_t *i = in + 3 * p;
+        uint8_t *o = out + 3 * p;
+
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i + 32));
+
+        const __m128i ch0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, c0a),
+                                                      _mm_shuffle_epi8(b, c0b)),
+                                         _mm_shuffle_epi8(c, c0c));
+        const __m128i ch1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, c1a),
+                                                      _mm_shuffle_epi8(b, c1b)),
+                                         _mm_shuffle_epi8(c, c1c));
+        const __m128i ch2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, c2a),
+                                                      _mm_shuffle_epi8(b, c2b)),
+                                         _mm_shuffle_epi8(c, c2c));
+
+        // Luma of pixels 0-7 and 8-15 as 16-bit lanes
+        __m128i y[2];
+        for (int h = 0; h < 2; h++) {
+            const __m128i b16 = h ? _mm_unpackhi_epi8(ch0, zero) : _mm_unpacklo_epi8(ch0, zero);
+            const __m128i g16 = h ? _mm_unpackhi_epi8(ch1, zero) : _mm_unpacklo_epi8(ch1, zero);
+            const __m128i r16 = h ? _mm_unpackhi_epi8(ch2, zero) : _mm_unpacklo_epi8(ch2, zero);
+            y[h] = _mm_packs_epi32(lumaPart(b16, g16, r16, false),
+                                   lumaPart(b16, g16, r16, true));
+        }
+
+        // lo <= y <= hi
+        const __m128i out0 = _mm_or_si128(_mm_cmplt_epi16(y[0], below), _mm_cmpgt_epi16(y[0], above));
+        const __m128i out1 = _mm_or_si128(_mm_cmplt_epi16(y[1], below), _mm_cmpgt_epi16(y[1], above));
+        const __m128i m = _mm_andnot_si128(_mm_packs_epi16(out0, out1), _mm_set1_epi8(-1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(o),
+                         _mm_and_si128(a, _mm_shuffle_epi8(m, ea)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(o + 16),
+                         _mm_and_si128(b, _mm_shuffle_epi8(m, eb)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(o + 32),
+                         _mm_and_si128(c, _mm_shuffle_epi8(m, ec)));
+    }
+
+    thresholdBGRScalar(in + 3 * p, out + 3 * p, pixels - p, lo, hi);
+}
+
+__attribute__((target("avx2")))
+void thresholdGreyAVX2(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi)
+{
+    // Bounds are clamped to [0, 255] by thresholdGrey()
+    const __m256i l = _mm256_set1_epi8(static_cast<char>(lo));
+    const __m256i h = _mm256_set1_epi8(static_cast<char>(hi));
+
+    size_t p = 0;
+    for (; p + 32 <= pixels; p += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + p));
+        const __m256i keep = _mm256_and_si256(
+            _mm256_cmpeq_epi8(_mm256_max_epu8(v, l), v),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, h), v));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + p), _mm256_and_si256(v, keep));
+    }
+
+    thresholdGreyScalar(in + p, out + p, pixels - p, lo, hi);
+}
+
+__attribute__((target("sse2")))
+void thresholdGreySSE2(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi)
+{
+    const __m128i l = _mm_set1_epi8(static_cast<char>(lo));
+    const __m128i h = _mm_set1_epi8(static_cast<char>(hi));
+
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + p));
+        const __m128i keep = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, l), v),
+                                           _mm_cmpeq_epi8(_mm_min_epu8(v, h), v));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + p), _mm_and_si128(v, keep));
+    }
+
+    thresholdGreyScalar(in + p, out + p, pixels - p, lo, hi);
+}
+
+#endif /* OAT_X86_KERNELS */
+
+using ThresholdFn = void (*)(const uint8_t *, uint8_t *, size_t, int, int);
+
+ThresholdFn selectThresholdBGR()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("ssse3"))
+        return thresholdBGRSSSE3;
+#endif
+    return thresholdBGRScalar;
+}
+
+ThresholdFn selectThresholdGrey()
+{
+#ifdef OAT_X86_KERNELS
+    if (__builtin_cpu_supports("avx2"))
+        return thresholdGreyAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return thresholdGreySSE2;
+#endif
+    return thresholdGreyScalar;
+}
+
+} /* namespace */
+
+void thresholdBGR(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi)
+{
+    // Empty passband
+    if (lo > 255 || hi < 0 || hi < lo) {
+        std::memset(out, 0, 3 * pixels);
+        return;
+    }
+
+    static const ThresholdFn fn = selectThresholdBGR();
+    fn(in, out, pixels, std::max(lo, 0), std::min(hi, 255));
+}
+
+void thresholdGrey(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi)
+{
+    // Empty passband
+    if (lo > 255 || hi < 0 || hi < lo) {
+        std::memset(out, 0, pixels);
+        return;
+    }
+
+    static const ThresholdFn fn = selectThresholdGrey();
+    fn(in, out, pixels, std::max(lo, 0), std::min(hi, 255));
+}
+
+} /* namespace kernel */
+} /* namespace oat */
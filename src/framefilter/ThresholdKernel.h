@@ -0,0 +1,55 @@
+//******************************************************************************
+//* File:   ThresholdKernel.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_THRESHOLDKERNEL_H
+#define	OAT_THRESHOLDKERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace oat {
+namespace kernel {
+
+/**
+ * @brief Keep BGR pixels whose luma is within [lo, hi] and zero the rest.
+ * Luma is computed as cv::cvtColor(..., COLOR_BGR2GRAY) does for 8-bit
+ * frames in OpenCV 3.x, so with OpenCV 3 the result matches cvtColor
+ * followed by cv::inRange. Later OpenCV releases round a few colours to an
+ * adjacent grey level, which only matters for pixels on a passband edge.
+ * @param in Interleaved BGR samples
+ * @param out Output BGR samples. May be the same as in.
+ * @param pixels Number of pixels
+ * @param lo Lower bound of the passband, inclusive
+ * @param hi Upper bound of the passband, inclusive
+ */
+void thresholdBGR(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi);
+
+/**
+ * @brief Keep grey pixels within [lo, hi] and zero the rest.
+ * @param in Grey samples
+ * @param out Output samples. May be the same as in.
+ * @param pixels Number of pixels
+ * @param lo Lower bound of the passband, inclusive
+ * @param hi Upper bound of the passband, inclusive
+ */
+void thresholdGrey(const uint8_t *in, uint8_t *out, size_t pixels, int lo, int hi);
+
+}      /* namespace kernel */
+}      /* namespace oat */
+#endif /* OAT_THRESHOLDKERNEL_H */
@@ -61,12 +61,9 @@ void Undistorter::appendOptions(po::options_description &opts)
         config_keys_.push_back(o->long_name());
 }
 
-void Undistorter::configure(const po::variables_map &vm)
+void Undistorter::configureFilter(const po::variables_map &vm,
+                                    const config::OptionTable &config_table)
 {
-    // Check for config file and entry correctness
-    auto config_table = oat::config::getConfigTable(vm);
-    oat::config::checkKeys(config_keys_, config_table);
-
     if (oat::config::getArray<double>(
             vm, config_table, "distortion-coeffs", dist_coeff_, true)) {
 
@@ -90,11 +87,44 @@ void Undistorter::configure(const po::variables_map &vm)
     }
 }
 
+oat::FrameParams Undistorter::outputParameters(const oat::FrameParams &in)
+{
+    // cv::undistort recomputes the full distortion model for every pixel of
+    // every frame. The model is fixed, so compute it once as a pair of
+    // fixed-point (CV_16SC2 + interpolation table) maps that cv::remap can
+    // apply with integer arithmetic. cv::remap splits the frame into row
+    // bands across the OpenCV thread pool.
+    cv::initUndistortRectifyMap(camera_matrix_,
+                                dist_coeff_,
+                                cv::Mat(),
+                                camera_matrix_,
+                                cv::Size(in.cols, in.rows),
+                                CV_16SC2,
+                                map1_,
+                                map2_);
+
+    return in;
+}
+
 void Undistorter::filter(cv::Mat &frame)
 {
-    cv::Mat temp = frame.clone();
-    // TODO: too slow -- GPU implementation.
-    cv::undistort(temp, frame, camera_matrix_, dist_coeff_);
+    cv::remap(frame, remapped_, map1_, map2_, cv::INTER_LINEAR);
+    remapped_.copyTo(frame);
+}
+
+void Undistorter::filter(const oat::Frame &in, oat::Frame &out)
+{
+    // Remap directly into the shared frame
+    cv::remap(in, out, map1_, map2_, cv::INTER_LINEAR);
+}
+
+void Undistorter::filterBand(const oat::Frame &in,
+                             oat::Frame &out,
+                             const cv::Range &rows)
+{
+    cv::Mat dst = out.rowRange(rows);
+    cv::remap(in, dst, map1_.rowRange(rows), map2_.rowRange(rows),
+              cv::INTER_LINEAR);
 }
 
 } /* namespace oat */
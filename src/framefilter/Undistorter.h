@@ -43,10 +43,19 @@ public:
                 const std::string &frame_sink_address);
 
     void appendOptions(po::options_description &opts) override;
-    void configure(const po::variables_map &vm) override;
 
 private:
 
+    void configureFilter(const po::variables_map &vm,
+                         const config::OptionTable &config_table) override;
+
+    /**
+     * Build the undistortion maps for the SOURCE frame size.
+     * @param in Format of SOURCE frames
+     * @return Format of SINK frames, which is unchanged
+     */
+    oat::FrameParams outputParameters(const oat::FrameParams &in) override;
+
     /**
      * Apply undistortion filter.
      * @param frame Unfiltered frame
@@ -54,8 +63,30 @@ private:
      */
     void filter(cv::Mat &frame) override;
 
+    /**
+     * Apply undistortion filter directly into the shared output frame.
+     * @param in Unfiltered frame
+     * @param out Filtered frame
+     */
+    void filter(const oat::Frame &in, oat::Frame &out) override;
+
+    /**
+     * Remap one band of output rows. Each output row samples input rows
+     * anywhere in the frame, so this never works in place.
+     */
+    Bands bands(void) const override { return Bands::NEIGHBOURHOOD; }
+    void filterBand(const oat::Frame &in,
+                    oat::Frame &out,
+                    const cv::Range &rows) override;
+
     cv::Matx33d camera_matrix_ {cv::Matx33d::eye()};
     std::vector<double> dist_coeff_;
+
+    // Fixed-point undistortion maps, computed once per frame size
+    cv::Mat map1_, map2_;
+
+    // Remap destination for in-place filtering (remap cannot work in place)
+    cv::Mat remapped_;
 };
 
 }      /* namespace oat */
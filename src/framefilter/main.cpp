@@ -29,14 +29,18 @@
 #include <cpptoml.h>
 #include <opencv2/core.hpp>
 
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ProgramOptions.h"
 
 #include "BackgroundSubtractor.h"
 #include "BackgroundSubtractorMOG.h"
+#include "BackgroundSubtractorSigmaDelta.h"
 #include "ColorConvert.h"
+#include "FilterChain.h"
 #include "FrameFilter.h"
 #include "FrameMasker.h"
+#include "Resizer.h"
 #include "Undistorter.h"
 #include "Threshold.h"
 
@@ -54,7 +58,11 @@ const char usage_type[] =
     "  mask: Binary mask\n"
     "  mog: Mixture of Gaussians background segmentation.\n"
     "  undistort: Correct for lens distortion using lens distortion model.\n"
-    "  thresh: Simple intensity threshold.";
+    "  thresh: Simple intensity threshold.\n"
+    "  sigma: Sigma-delta background segmentation. Fast CPU alternative to mog.\n"
+    "  resize: Crop to a region of interest and/or downsample.\n"
+    "  A comma separated list of TYPEs (e.g. col,mask,bsub) applies each\n"
+    "  filter in turn to the same frame within one process.";
 
 const char usage_io[] =
     "SOURCE:\n"
@@ -119,6 +127,7 @@ void run(const std::shared_ptr<oat::FrameFilter> filter) {
 int main(int argc, char *argv[]) {
 
     std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
 
     // Results of command line input
     std::string type;
@@ -133,6 +142,8 @@ int main(int argc, char *argv[]) {
     type_hash["undistort"] = 'd';
     type_hash["col"] = 'e';
     type_hash["thresh"] = 'f';
+    type_hash["sigma"] = 'h';
+    type_hash["resize"] = 'i';
 
     // The component itself
     std::string comp_name = "framefilt";
@@ -189,8 +200,9 @@ int main(int argc, char *argv[]) {
         // program options
         if (option_map.count("type")) {
 
-            // Refine component type
-            switch (type_hash[type]) {
+            // Refine component type. A list of types is a fused chain.
+            const bool chain = type.find(',') != std::string::npos;
+            switch (chain ? 'g' : type_hash[type]) {
                 case 'a':
                 {
                     filter = std::make_shared<oat::BackgroundSubtractor>(source, sink);
@@ -221,6 +233,21 @@ int main(int argc, char *argv[]) {
                     filter = std::make_shared<oat::Threshold>(source, sink);
                     break;
                 }
+                case 'g':
+                {
+                    filter = std::make_shared<oat::FilterChain>(source, sink, type);
+                    break;
+                }
+                case 'h':
+                {
+                    filter = std::make_shared<oat::BackgroundSubtractorSigmaDelta>(source, sink);
+                    break;
+                }
+                case 'i':
+                {
+                    filter = std::make_shared<oat::Resizer>(source, sink);
+                    break;
+                }
                 default:
                 {
                     printUsage(visible_options, "");
@@ -51,6 +51,20 @@ void FileReader::appendOptions(po::options_description &opts)
          "defining a rectangular region of interest. Origin"
          "is upper left corner. ROI must fit within acquired"
          "frame size. Defaults to full video size.")
+        ("ring-depth", po::value<size_t>(),
+         "Number of frames that can be served ahead of the slowest "
+         "component reading them. Values greater than 1 allow downstream "
+         "components to briefly lag without blocking acquisition at the "
+         "cost of additional shared memory. Defaults to 1.")
+        ("huge-pages",
+         "If true, back shared frames with transparent huge pages if the "
+         "kernel allows it. Reduces TLB misses when reading large frames.")
+        ("prefault",
+         "If true, fault in all shared frame memory at startup rather than "
+         "when the first frames are served.")
+        ("mlock",
+         "If true, lock shared frame memory into RAM so that it cannot be "
+         "paged out.")
         ;
 
     opts.add(local_opts);
@@ -85,6 +99,19 @@ void FileReader::configure(const po::variables_map &vm)
         region_of_interest_.width  = roi[2];
         region_of_interest_.height = roi[3];
     }
+
+    // Ring depth
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "ring-depth", ring_depth_, 1, oat::Node::MAX_DEPTH
+    );
+
+    // Shared frame memory
+    oat::config::getValue<bool>(
+        vm, config_table, "huge-pages", segment_options_.huge_pages);
+    oat::config::getValue<bool>(
+        vm, config_table, "prefault", segment_options_.prefault);
+    oat::config::getValue<bool>(
+        vm, config_table, "mlock", segment_options_.lock);
 }
 
 void FileReader::connectToNode()
@@ -96,7 +123,9 @@ void FileReader::connectToNode()
         example_frame = example_frame(region_of_interest_);
 
     frame_sink_.bind(frame_sink_address_,
-            example_frame.total() * example_frame.elemSize());
+            example_frame.total() * example_frame.elemSize(), ring_depth_,
+            segment_options_);
+    checkSegmentOptions();
 
     shared_frame_ = frame_sink_.retrieve(
             example_frame.rows, example_frame.cols, example_frame.type(), PIX_BGR);
@@ -113,6 +142,7 @@ bool FileReader::process()
     cv::Mat frame;
     if (!file_reader_.read(frame)) 
         return true;
+    const uint64_t captured = oat::Sample::monotonicNs();
 
     if (use_roi_ )
         frame = frame(region_of_interest_);
@@ -123,8 +153,10 @@ bool FileReader::process()
     // Wait for sources to read
     frame_sink_.wait();
 
+    shared_frame_ = frame_sink_.retrieve();
     frame.copyTo(shared_frame_);
     shared_frame_.incrementSampleCount();
+    shared_frame_.set_capture_ns(captured);
 
     // Tell sources there is new data
     frame_sink_.post();
@@ -19,8 +19,11 @@
 
 #include "FrameServer.h"
 
+#include <iostream>
 #include <string>
 
+#include "../../lib/utility/IOFormat.h"
+
 namespace oat {
 
 FrameServer::FrameServer(const std::string &frame_sink_address) :
@@ -40,4 +43,23 @@ void FrameServer::appendOptions(po::options_description &opts) {
         ;
 }
 
+void FrameServer::checkSegmentOptions() const {
+
+    const auto applied = frame_sink_.segment_options();
+
+    if (segment_options_.huge_pages && !applied.huge_pages)
+        std::cerr << oat::whoWarn(name_,
+                "Huge pages are not available for shared memory. "
+                "Using standard pages.\n");
+
+    if (segment_options_.prefault && !applied.prefault)
+        std::cerr << oat::whoWarn(name_,
+                "Shared memory could not be prefaulted.\n");
+
+    if (segment_options_.lock && !applied.lock)
+        std::cerr << oat::whoWarn(name_,
+                "Shared memory could not be locked into RAM. "
+                "Check the memory lock limit (ulimit -l).\n");
+}
+
 } /* namespace oat */
@@ -89,6 +89,18 @@ protected:
     const std::string frame_sink_address_;
     oat::Sink<oat::Frame> frame_sink_;
 
+    // Number of frames the sink may write ahead of its slowest source
+    size_t ring_depth_ {1};
+
+    // Requested shared frame memory options
+    oat::SegmentOptions segment_options_;
+
+    /**
+     * @brief Warn about requested shared frame memory options that could not
+     * be honored when the frame sink was bound.
+     */
+    void checkSegmentOptions(void) const;
+
     // Currently acquired, shared frame
     //bool frame_empty_ {true};
     oat::Frame shared_frame_;
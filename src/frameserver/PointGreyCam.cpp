@@ -713,6 +713,7 @@ bool PointGreyCam<T>::process()
 {
     pg::Image raw_image;
     int rc = grabImage(&raw_image);
+    const uint64_t captured = oat::Sample::monotonicNs();
 
     // There was a grab timeout.
     // Allow check to see if SIGINT occurred.
@@ -740,6 +741,7 @@ bool PointGreyCam<T>::process()
             shmem_image_->DeepCopy(&raw_image);
 
         shared_frame_.incrementSampleCount(tick_);
+        shared_frame_.set_capture_ns(captured);
 
         // Tell sources there is new data
         frame_sink_.post();
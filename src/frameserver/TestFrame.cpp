@@ -54,6 +54,20 @@ void TestFrame::appendOptions(po::options_description &opts)
          "Frames to serve per second.")
         ("num-frames,n", po::value<uint64_t>(),
          "Number of frames to serve before exiting.")
+        ("ring-depth", po::value<size_t>(),
+         "Number of frames that can be served ahead of the slowest "
+         "component reading them. Values greater than 1 allow downstream "
+         "components to briefly lag without blocking acquisition at the "
+         "cost of additional shared memory. Defaults to 1.")
+        ("huge-pages",
+         "If true, back shared frames with transparent huge pages if the "
+         "kernel allows it. Reduces TLB misses when reading large frames.")
+        ("prefault",
+         "If true, fault in all shared frame memory at startup rather than "
+         "when the first frames are served.")
+        ("mlock",
+         "If true, lock shared frame memory into RAM so that it cannot be "
+         "paged out.")
         ;
 
     opts.add(local_opts);
@@ -86,6 +100,19 @@ void TestFrame::configure(const po::variables_map &vm) {
     // Frame rate
     if (oat::config::getNumericValue(vm, config_table, "fps", frames_per_second_, 0.0))
         calculateFramePeriod();
+
+    // Ring depth
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "ring-depth", ring_depth_, 1, oat::Node::MAX_DEPTH
+    );
+
+    // Shared frame memory
+    oat::config::getValue<bool>(
+        vm, config_table, "huge-pages", segment_options_.huge_pages);
+    oat::config::getValue<bool>(
+        vm, config_table, "prefault", segment_options_.prefault);
+    oat::config::getValue<bool>(
+        vm, config_table, "mlock", segment_options_.lock);
 }
 
 void TestFrame::connectToNode() {
@@ -96,13 +123,16 @@ void TestFrame::connectToNode() {
         throw (std::runtime_error("File \"" + file_name_ + "\" could not be read."));
 
     frame_sink_.bind(frame_sink_address_,
-            mat.total() * mat.elemSize());
+            mat.total() * mat.elemSize(), ring_depth_, segment_options_);
+    checkSegmentOptions();
 
     shared_frame_ = frame_sink_.retrieve(
             mat.rows, mat.cols, mat.type(), color_);
 
-    // Static image, never changes
+    // Static image, never changes. Keep it to fill the remaining ring slots.
     mat.copyTo(shared_frame_);
+    if (ring_depth_ > 1)
+        test_image_ = mat;
 
     // Put the sample rate in the shared frame
     shared_frame_.set_rate_hz(1.0 / frame_period_in_sec_.count());
@@ -118,8 +148,16 @@ bool TestFrame::process()
         // Wait for sources to read
         frame_sink_.wait();
 
+        // Each ring slot is filled with the static image on first use
+        if (ring_depth_ > 1) {
+            shared_frame_ = frame_sink_.retrieve();
+            if (shared_frame_.sample_count() < ring_depth_)
+                test_image_.copyTo(shared_frame_);
+        }
+
         // Zero frame copy
         shared_frame_.incrementSampleCount();
+        shared_frame_.set_capture_ns();
 
         // Tell sources there is new data
         frame_sink_.post();
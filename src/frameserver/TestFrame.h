@@ -47,6 +47,7 @@ private:
 
     // Image file
     std::string file_name_;
+    cv::Mat test_image_;
 
     // Frame speed
     double frames_per_second_;
@@ -53,6 +53,20 @@ void WebCam::appendOptions(po::options_description &opts)
          "defining a rectangular region of interest. Origin"
          "is upper left corner. ROI must fit within acquired"
          "mat size. Defaults to full sensor size.")
+        ("ring-depth", po::value<size_t>(),
+         "Number of frames that can be served ahead of the slowest "
+         "component reading them. Values greater than 1 allow downstream "
+         "components to briefly lag without blocking acquisition at the "
+         "cost of additional shared memory. Defaults to 1.")
+        ("huge-pages",
+         "If true, back shared frames with transparent huge pages if the "
+         "kernel allows it. Reduces TLB misses when reading large frames.")
+        ("prefault",
+         "If true, fault in all shared frame memory at startup rather than "
+         "when the first frames are served.")
+        ("mlock",
+         "If true, lock shared frame memory into RAM so that it cannot be "
+         "paged out.")
         ;
 
     opts.add(local_opts);
@@ -94,6 +108,19 @@ void WebCam::configure(const po::variables_map &vm)
         region_of_interest_.width  = roi[2];
         region_of_interest_.height = roi[3];
     }
+
+    // Ring depth
+    oat::config::getNumericValue<size_t>(
+        vm, config_table, "ring-depth", ring_depth_, 1, oat::Node::MAX_DEPTH
+    );
+
+    // Shared frame memory
+    oat::config::getValue<bool>(
+        vm, config_table, "huge-pages", segment_options_.huge_pages);
+    oat::config::getValue<bool>(
+        vm, config_table, "prefault", segment_options_.prefault);
+    oat::config::getValue<bool>(
+        vm, config_table, "mlock", segment_options_.lock);
 }
 
 void WebCam::connectToNode()
@@ -105,7 +132,10 @@ void WebCam::connectToNode()
         example_frame = example_frame(region_of_interest_);
 
     frame_sink_.bind(frame_sink_address_,
-                     example_frame.total() * oat::color_bytes(oat::PIX_BGR));
+                     example_frame.total() * oat::color_bytes(oat::PIX_BGR),
+                     ring_depth_,
+                     segment_options_);
+    checkSegmentOptions();
 
     shared_frame_ = frame_sink_.retrieve(
         example_frame.rows, example_frame.cols, example_frame.type(), oat::PIX_BGR);
@@ -121,6 +151,7 @@ bool WebCam::process()
     cv::Mat mat;
     if (!cv_camera_->read(mat)) 
         return true;
+    const uint64_t captured = oat::Sample::monotonicNs();
 
     if (use_roi_ )
         mat = mat(region_of_interest_);
@@ -134,6 +165,8 @@ bool WebCam::process()
     // Wait for sources to read
     frame_sink_.wait();
 
+    shared_frame_ = frame_sink_.retrieve();
+
     // Pure SINKs increment sample count
     // NOTE: webcams have poorly controlled sample period, so it must be
     // calculated. This operation is very inexpensive
@@ -145,6 +178,7 @@ bool WebCam::process()
                                                                - start_);
         shared_frame_.incrementSampleCount(time_since_start);
     }
+    shared_frame_.set_capture_ns(captured);
 
     mat.copyTo(shared_frame_);
 
@@ -29,6 +29,7 @@
 #include <cpptoml.h>
 #include <opencv2/core.hpp>
 
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ProgramOptions.h"
 
@@ -115,6 +116,7 @@ void run(const std::shared_ptr<oat::FrameServer> &server)
 int main(int argc, char *argv[])
 {
     std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
 
     // Results of command line input
     std::string type;
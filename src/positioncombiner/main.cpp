@@ -29,6 +29,7 @@
 #include <boost/interprocess/exceptions.hpp>
 #include <opencv2/core.hpp>
 
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ProgramOptions.h"
 
@@ -107,6 +108,7 @@ void run(const std::shared_ptr<oat::PositionCombiner>& combiner) {
 int main(int argc, char *argv[]) {
 
     std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
 
     // Results of command line input
     std::vector<std::string> sources;
@@ -43,7 +43,7 @@ public:
     DifferenceDetector(const std::string &frame_source_address,
                        const std::string &position_sink_address);
 
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     void appendOptions(po::options_description &opts) override;
     void configure(const po::variables_map &vm) override;
@@ -80,7 +80,7 @@ private:
     bool tuning_windows_created_ {false};
     void createTuningWindows(void);
     void tune(cv::Mat &frame, const oat::Position2D &position);
-    void applyThreshold(cv::Mat &frame);
+    void applyThreshold(const cv::Mat &frame);
 
 };
 
@@ -57,7 +57,7 @@ public:
      * @param Frame to look for object within.
      * @param position Detected object position.
      */
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     void appendOptions(po::options_description &opts) override;
     void configure(const po::variables_map &vm) override;
@@ -76,6 +76,7 @@ private:
 
     // Internal matricies
     cv::Mat threshold_frame_, erode_element_, dilate_element_;
+    cv::Mat tune_frame_;
 
     // HSV threshold values
     int h_min_ {0}, h_max_ {256};
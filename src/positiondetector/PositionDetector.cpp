@@ -62,29 +62,27 @@ void PositionDetector::connectToNode()
 
 bool PositionDetector::process()
 {
-    oat::Frame internal_frame;
     oat::Position2D internal_pos("");
 
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sink to write to node
-    if (frame_source_.wait() == oat::NodeState::END)
+    // Wait for sink to write to node and lease the shared frame
+    auto frame = frame_source_.acquire();
+    if (!frame)
         return true;
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame);
+    // Propagate sample info and detect position directly in shared memory
+    internal_pos.set_sample(frame->sample());
+    detectPosition(*frame, internal_pos);
+    internal_pos.stampHop();
 
     // Tell sink it can continue
-    frame_source_.post();
+    frame.release();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Propagate sample info and detect position
-    internal_pos.set_sample(internal_frame.sample());
-    detectPosition(internal_frame, internal_pos);
-
     // START CRITICAL SECTION //
     ////////////////////////////
 
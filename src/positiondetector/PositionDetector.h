@@ -91,7 +91,7 @@ protected:
      * @param Frame to look for object within.
      * @param position Detected object position.
      */
-    virtual void detectPosition(cv::Mat &frame, oat::Position2D &position) = 0;
+    virtual void detectPosition(const cv::Mat &frame, oat::Position2D &position) = 0;
 
     // Detector name
     const std::string name_;
@@ -121,7 +121,7 @@ void SimpleThreshold::configure(const po::variables_map &vm)
     oat::config::getValue<bool>(vm, config_table, "tune", tuning_on_);
 }
 
-void SimpleThreshold::detectPosition(cv::Mat &frame, oat::Position2D &position)
+void SimpleThreshold::detectPosition(const cv::Mat &frame, oat::Position2D &position)
 {
     if (tuning_on_)
         tune_frame_ = frame.clone();
@@ -176,7 +176,7 @@ void SimpleThreshold::tune(cv::Mat &frame, const oat::Position2D &position)
     cv::waitKey(1);
 }
 
-void SimpleThreshold::applyThreshold(cv::Mat &frame)
+void SimpleThreshold::applyThreshold(const cv::Mat &frame)
 {
     cv::inRange(frame,
                 t_min_,
@@ -44,7 +44,7 @@ public:
     SimpleThreshold(const std::string &frame_source_address,
                     const std::string &position_sink_address);
 
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     void appendOptions(po::options_description &opts) override;
     void configure(const po::variables_map &vm) override;
@@ -86,7 +86,7 @@ private:
     // Processing functions
     void createTuningWindows(void);
     void tune(cv::Mat &frame, const oat::Position2D &position);
-    void applyThreshold(cv::Mat &frame);
+    void applyThreshold(const cv::Mat &frame);
 };
 
 // Tuning GUI callbacks
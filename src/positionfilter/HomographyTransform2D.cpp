@@ -82,6 +82,26 @@ void HomographyTransform2D::filter(oat::Position2D& position) {
     // TODO: If the homography_is not valid, I should warn the user...
     if (homography_valid_) {
 
+        // The homography is calibrated on full resolution frames. Undo any
+        // cropping or downsampling that happened before detection.
+        const auto &s = position.sample();
+        if (position.unit_of_length() == oat::DistanceUnit::PIXELS
+            && !s.full_resolution()) {
+
+            const auto k = s.pixel_scale();
+            position.position = s.toFullResolution(position.position);
+            position.velocity = oat::Velocity2D(k.x * position.velocity.x,
+                                                k.y * position.velocity.y);
+            position.heading = oat::UnitVector2D(k.x * position.heading.x,
+                                                 k.y * position.heading.y);
+
+            // Unequal axis scales change the heading's length as well as
+            // its direction
+            const double heading_length = cv::norm(position.heading);
+            if (heading_length > 0)
+                position.heading /= heading_length;
+        }
+
         // Position transform
         if (position.position_valid) {
             std::vector<oat::Point2D> in_positions;
@@ -75,6 +75,7 @@ bool PositionFilter::process()
 
     // Mess with internal frame
     filter(internal_position_);
+    internal_position_.stampHop();
 
     // START CRITICAL SECTION //
     ////////////////////////////
@@ -69,6 +69,7 @@ bool PositionGenerator::process()
 {
     // Generate internal position
     bool eof = generatePosition(internal_position_);
+    internal_position_.set_capture_ns();
 
     // START CRITICAL SECTION //
     ////////////////////////////
@@ -29,6 +29,7 @@
 #include <boost/program_options.hpp>
 #include <cpptoml.h>
 
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ProgramOptions.h"
 
@@ -108,6 +109,7 @@ void run(std::shared_ptr<oat::PositionGenerator> posigen)
 int main(int argc, char *argv[])
 {
     std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
 
     // Results of command line input
     std::string type;
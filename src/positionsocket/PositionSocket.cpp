@@ -63,6 +63,7 @@ bool PositionSocket::process()
 
     // Clone the shared position
     internal_position_ = position_source_.clone();
+    internal_position_.stampHop();
 
     // Tell sink it can continue
     position_source_.post();
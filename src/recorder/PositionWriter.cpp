@@ -163,7 +163,11 @@ void PositionWriter::write() {
 
 void PositionWriter::push() {
 
-    if (!buffer_.push(source_.clone()))
+    // Stamp on arrival rather than when the writer thread gets to it
+    auto p = source_.clone();
+    p.stampHop();
+
+    if (!buffer_.push(p))
         throw std::runtime_error(overrun_msg);
 }
 
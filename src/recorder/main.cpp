@@ -29,6 +29,7 @@
 #include <boost/iostreams/stream.hpp>
 #include <boost/program_options.hpp>
 
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/ZMQStream.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/IOUtility.h"
@@ -104,6 +105,7 @@ void run(std::shared_ptr<oat::Recorder> &recorder)
 int main(int argc, char *argv[]) {
 
     std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
 
     // The component itself
     std::string comp_name = "recorder";
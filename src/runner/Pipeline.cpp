@@ -0,0 +1,418 @@
+//******************************************************************************
+//* File:   Pipeline.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <cpptoml.h>
+#include <opencv2/core.hpp>
+
+#include "../../lib/shmemdf/LocalNode.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "../frameserver/FileReader.h"
+#include "../frameserver/TestFrame.h"
+#include "../frameserver/WebCam.h"
+#ifdef USE_FLYCAP
+ #include "FlyCapture2.h"
+ #include "../frameserver/PointGreyCam.h"
+ namespace pg = FlyCapture2;
+#endif
+#include "../framefilter/BackgroundSubtractor.h"
+#include "../framefilter/BackgroundSubtractorMOG.h"
+#include "../framefilter/BackgroundSubtractorSigmaDelta.h"
+#include "../framefilter/ColorConvert.h"
+#include "../framefilter/FilterChain.h"
+#include "../framefilter/FrameMasker.h"
+#include "../framefilter/Resizer.h"
+#include "../framefilter/Threshold.h"
+#include "../framefilter/Undistorter.h"
+#include "../positiondetector/DifferenceDetector.h"
+#include "../positiondetector/HSVDetector.h"
+#include "../positiondetector/SimpleThreshold.h"
+#include "../positionfilter/HomographyTransform2D.h"
+#include "../positionfilter/KalmanFilter2D.h"
+#include "../positionfilter/RegionFilter2D.h"
+#include "../positionsocket/PositionCout.h"
+#include "../positionsocket/PositionPublisher.h"
+#include "../positionsocket/PositionReplier.h"
+#include "../positionsocket/UDPPositionClient.h"
+
+#include "Pipeline.h"
+
+namespace oat {
+
+namespace {
+
+// Adapts any of the component ABCs to a Stage
+template <typename T>
+class ComponentStage : public Stage {
+public:
+
+    explicit ComponentStage(T *component)
+    : component_(component)
+    {
+        // Nothing
+    }
+
+    std::string name(void) const override { return component_->name(); }
+
+    void appendOptions(po::options_description &opts) override
+    {
+        component_->appendOptions(opts);
+    }
+
+    void configure(const po::variables_map &vm) override
+    {
+        component_->configure(vm);
+    }
+
+    void connectToNode(void) override { component_->connectToNode(); }
+    bool process(void) override { return component_->process(); }
+
+private:
+
+    std::unique_ptr<T> component_;
+};
+
+template <typename T>
+std::unique_ptr<Stage> wrap(T *component)
+{
+    return std::unique_ptr<Stage>(new ComponentStage<T>(component));
+}
+
+// Components that can be hosted by a pipeline and the node addresses they
+// require
+struct ComponentIO {
+    const char *name;
+    bool source;
+    bool sink;
+};
+
+const ComponentIO component_io[] = {
+    {"frameserve", false, true},
+    {"framefilt",  true,  true},
+    {"posidet",    true,  true},
+    {"posifilt",   true,  true},
+    {"posisock",   true,  false},
+};
+
+const ComponentIO &componentIO(const std::string &component)
+{
+    for (const auto &c : component_io)
+        if (component == c.name)
+            return c;
+
+    throw std::runtime_error("Component '" + component
+                             + "' cannot be used in a pipeline.");
+}
+
+std::string stringValue(const config::OptionTable &table,
+                        const std::string &key,
+                        const std::string &file)
+{
+    if (!table->contains(key))
+        return "";
+
+    auto val = table->get_as<std::string>(key);
+    if (!val)
+        throw std::runtime_error(config::valueError(
+                key, "stage", file, "must be a STRING"));
+
+    return *val;
+}
+
+} /* namespace */
+
+Pipeline::Pipeline(const std::string &file)
+: file_(file)
+{
+    // Will throw if file contains bad syntax
+    auto config = cpptoml::parse_file(file_);
+
+    auto stages = config->get_table_array("stage");
+    if (!stages)
+        throw std::runtime_error("No [[stage]] entries were provided in '"
+                                 + file_ + "'.");
+
+    const std::vector<std::string> keys {"component", "type", "source",
+                                         "sink", "config"};
+
+    for (const auto &t : *stages) {
+
+        config::checkKeys(keys, t);
+
+        StageSpec s;
+        s.component = stringValue(t, "component", file_);
+        s.type = stringValue(t, "type", file_);
+        s.source = stringValue(t, "source", file_);
+        s.sink = stringValue(t, "sink", file_);
+        s.config = stringValue(t, "config", file_);
+
+        if (s.component.empty() || s.type.empty())
+            throw std::runtime_error(
+                "Each stage must specify a component and a type.");
+
+        const auto &io = componentIO(s.component);
+        if (io.source == s.source.empty())
+            throw std::runtime_error("Stage '" + s.component + " " + s.type
+                + (io.source ? "' requires" : "' does not take") + " a source.");
+        if (io.sink == s.sink.empty())
+            throw std::runtime_error("Stage '" + s.component + " " + s.type
+                + (io.sink ? "' requires" : "' does not take") + " a sink.");
+
+        if (!s.config.empty() && !config->contains(s.config))
+            throw std::runtime_error(config::noTableError(s.config, file_));
+
+        stages_.push_back(s);
+    }
+}
+
+std::unique_ptr<Stage> Pipeline::makeStage(const StageSpec &s) const
+{
+    const auto &c = s.component;
+    const auto &t = s.type;
+
+    if (c == "frameserve") {
+        if (t == "wcam") return wrap(new WebCam(s.sink));
+        if (t == "file") return wrap(new FileReader(s.sink));
+        if (t == "test") return wrap(new TestFrame(s.sink));
+#ifdef USE_FLYCAP
+        if (t == "gige") return wrap(new PointGreyCam<pg::GigECamera>(s.sink));
+        if (t == "usb") return wrap(new PointGreyCam<pg::Camera>(s.sink));
+#endif
+    } else if (c == "framefilt") {
+        if (t.find(',') != std::string::npos)
+            return wrap(new FilterChain(s.source, s.sink, t));
+        if (t == "bsub") return wrap(new BackgroundSubtractor(s.source, s.sink));
+        if (t == "mask") return wrap(new FrameMasker(s.source, s.sink));
+        if (t == "mog") return wrap(new BackgroundSubtractorMOG(s.source, s.sink));
+        if (t == "sigma") return wrap(new BackgroundSubtractorSigmaDelta(s.source, s.sink));
+        if (t == "undistort") return wrap(new Undistorter(s.source, s.sink));
+        if (t == "col") return wrap(new ColorConvert(s.source, s.sink));
+        if (t == "thresh") return wrap(new Threshold(s.source, s.sink));
+        if (t == "resize") return wrap(new Resizer(s.source, s.sink));
+    } else if (c == "posidet") {
+        if (t == "diff") return wrap(new DifferenceDetector(s.source, s.sink));
+        if (t == "hsv") return wrap(new HSVDetector(s.source, s.sink));
+        if (t == "thresh") return wrap(new SimpleThreshold(s.source, s.sink));
+    } else if (c == "posifilt") {
+        if (t == "kalman") return wrap(new KalmanFilter2D(s.source, s.sink));
+        if (t == "homography") return wrap(new HomographyTransform2D(s.source, s.sink));
+        if (t == "region") return wrap(new RegionFilter2D(s.source, s.sink));
+    } else if (c == "posisock") {
+        if (t == "pub") return wrap(new PositionPublisher(s.source));
+        if (t == "rep") return wrap(new PositionReplier(s.source));
+        if (t == "udp") return wrap(new UDPPositionClient(s.source));
+        if (t == "std") return wrap(new PositionCout(s.source));
+    }
+
+    throw std::runtime_error("Invalid TYPE '" + t + "' for component '" + c
+                             + "'.");
+}
+
+std::vector<std::string> Pipeline::commandLine(const StageSpec &spec) const
+{
+    std::vector<std::string> args {"oat-" + spec.component, spec.type};
+
+    if (!spec.source.empty())
+        args.push_back(spec.source);
+
+    if (!spec.sink.empty())
+        args.push_back(spec.sink);
+
+    if (!spec.config.empty()) {
+        args.push_back("--config");
+        args.push_back(file_);
+        args.push_back(spec.config);
+    }
+
+    return args;
+}
+
+bool Pipeline::runThreads(const volatile sig_atomic_t &quit)
+{
+    // Nodes between two stages of this pipeline are kept on the heap rather
+    // than in /dev/shm. Nodes that only have one end here, e.g. the SOURCE of
+    // the first stage, are still shared with other processes.
+    std::set<std::string> sinks;
+    for (const auto &spec : stages_)
+        if (!spec.sink.empty())
+            sinks.insert(spec.sink);
+
+    for (const auto &spec : stages_)
+        if (!spec.source.empty() && sinks.count(spec.source))
+            LocalNode::reserve(spec.source);
+
+    // Construct and configure every stage before starting any of them so
+    // that configuration errors are reported up front
+    std::vector<std::unique_ptr<Stage>> stages;
+    for (const auto &spec : stages_) {
+
+        auto stage = makeStage(spec);
+
+        po::options_description opts;
+        stage->appendOptions(opts);
+
+        // Parse the same options that would be passed to the stand-alone
+        // component
+        auto cmd = commandLine(spec);
+        std::vector<std::string> args(
+            std::find(cmd.begin(), cmd.end(), "--config"), cmd.end());
+
+        po::variables_map vm;
+        po::store(po::command_line_parser(args).options(opts).run(), vm);
+        po::notify(vm);
+        stage->configure(vm);
+
+        stages.push_back(std::move(stage));
+    }
+
+    // A failing stage brings down the rest of the pipeline
+    std::atomic<bool> stop {false};
+    std::atomic<bool> failed {false};
+    std::atomic<size_t> running {stages.size()};
+
+    auto run = [&quit, &stop, &failed, &running](std::unique_ptr<Stage> &stage) {
+
+        const auto name = stage->name();
+
+        try {
+
+            stage->connectToNode();
+
+            bool source_eof = false;
+            while (!quit && !stop && !source_eof)
+                source_eof = stage->process();
+
+        } catch (const boost::interprocess::interprocess_exception &ex) {
+
+            // Error code 1 indicates a SIGNINT during a call to wait(), which
+            // is normal behavior
+            if (ex.get_error_code() != 1) {
+                std::cerr << whoError(name, ex.what()) << std::endl;
+                failed = true;
+            }
+        } catch (const std::runtime_error &ex) {
+            std::cerr << whoError(name, ex.what()) << std::endl;
+            failed = true;
+        } catch (const cv::Exception &ex) {
+            std::cerr << whoError(name, ex.what()) << std::endl;
+            failed = true;
+        } catch (...) {
+            std::cerr << whoError(name, "Unknown exception.") << std::endl;
+            failed = true;
+        }
+
+        if (failed)
+            stop = true;
+
+        // Destroying the stage releases its nodes so that neighboring stages
+        // see it leave
+        stage.reset();
+        running--;
+    };
+
+    // SIGINT must be handled by the calling thread: a stage interrupted
+    // mid-wait() would exit without its neighbors noticing
+    sigset_t sigint, old_mask;
+    sigemptyset(&sigint);
+    sigaddset(&sigint, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &sigint, &old_mask);
+
+    std::vector<std::thread> threads;
+    for (auto &s : stages)
+        threads.emplace_back(run, std::ref(s));
+
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+
+    // quit and stop are only checked between calls to process(). Stages
+    // blocked in wait() on a node, e.g. waiting on an upstream stage that
+    // has failed or on a downstream stage that has stopped reading, must be
+    // woken: end every local node and make waits on shared nodes give up.
+    while (running > 0) {
+        if (quit || stop) {
+            LocalNode::cancelAll();
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    for (auto &t : threads)
+        t.join();
+
+    return !failed;
+}
+
+bool Pipeline::runProcesses(void)
+{
+    std::vector<pid_t> children;
+
+    for (const auto &spec : stages_) {
+
+        auto args = commandLine(spec);
+        std::vector<char *> argv;
+        for (auto &a : args)
+            argv.push_back(&a[0]);
+        argv.push_back(nullptr);
+
+        const pid_t pid = fork();
+        if (pid == 0) {
+            execvp(argv[0], argv.data());
+            std::cerr << Error("Could not execute " + args[0] + ".\n");
+            _exit(127);
+        } else if (pid < 0) {
+            throw std::runtime_error("Could not start " + args[0] + ".");
+        }
+
+        children.push_back(pid);
+    }
+
+    // Children receive SIGINT from the terminal directly, so just wait for
+    // them to exit
+    bool ok = true;
+    for (auto pid : children) {
+
+        int status;
+        pid_t rc;
+        do {
+            rc = waitpid(pid, &status, 0);
+        } while (rc == -1 && errno == EINTR);
+
+        if (rc == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            ok = false;
+    }
+
+    return ok;
+}
+
+}      /* namespace oat */
@@ -0,0 +1,118 @@
+//******************************************************************************
+//* File:   Pipeline.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PIPELINE_H
+#define	OAT_PIPELINE_H
+
+#include <csignal>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+namespace oat {
+
+namespace po = boost::program_options;
+
+/**
+ * @brief A single component of a pipeline. Each of the component ABCs
+ * (FrameServer, FrameFilter, PositionDetector, ...) shares this life cycle.
+ */
+class Stage {
+public:
+
+    virtual ~Stage() { }
+
+    virtual std::string name(void) const = 0;
+    virtual void appendOptions(po::options_description &opts) = 0;
+    virtual void configure(const po::variables_map &vm) = 0;
+    virtual void connectToNode(void) = 0;
+
+    /**
+     * @brief Perform a single processing step.
+     * @return true if the stage's SOURCE is exhausted and it should exit.
+     */
+    virtual bool process(void) = 0;
+};
+
+/**
+ * @brief Stage description from an entry in a pipeline file.
+ */
+struct StageSpec {
+    std::string component;  //!< Component command, e.g. framefilt
+    std::string type;       //!< Component TYPE, e.g. bsub
+    std::string source;     //!< SOURCE node address, if any
+    std::string sink;       //!< SINK node address, if any
+    std::string config;     //!< Key of this stage's configuration table, if any
+};
+
+/**
+ * @brief A set of components described by a single TOML file. Each
+ * `[[stage]]` entry in the file names a component, its TYPE, SOURCE and SINK,
+ * and optionally the key of a configuration table in the same file. The
+ * pipeline can either be hosted in this process, with each stage on its own
+ * thread, or as separate processes using the normal oat commands.
+ */
+class Pipeline {
+public:
+
+    /**
+     * @brief Parse a pipeline file.
+     * @param file Path to pipeline TOML file.
+     */
+    explicit Pipeline(const std::string &file);
+
+    /**
+     * @brief Construct and configure each stage and run it on its own
+     * thread. Adjacent stages exchange samples through local nodes that
+     * hold reference counted frames on the heap, so nothing is copied and
+     * nothing is placed in /dev/shm. Nodes shared with components outside
+     * the pipeline are opened in shared memory as usual. Returns once all
+     * stages have exited.
+     * @param quit Set asynchronously to request that all stages exit.
+     * @return true if all stages exited normally.
+     */
+    bool runThreads(const volatile sig_atomic_t &quit);
+
+    /**
+     * @brief Run each stage as a separate oat-COMPONENT process. Returns
+     * once all processes have exited.
+     * @return true if all processes exited normally.
+     */
+    bool runProcesses(void);
+
+    /**
+     * @brief Command line used to run a stage as a separate process.
+     * @param spec Stage description
+     */
+    std::vector<std::string> commandLine(const StageSpec &spec) const;
+
+    const std::vector<StageSpec> &stages(void) const { return stages_; }
+
+private:
+
+    const std::string file_;
+    std::vector<StageSpec> stages_;
+
+    std::unique_ptr<Stage> makeStage(const StageSpec &spec) const;
+};
+
+}      /* namespace oat */
+#endif /* OAT_PIPELINE_H */
@@ -0,0 +1,182 @@
+//******************************************************************************
+//* File:   oat run main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <csignal>
+#include <iostream>
+#include <string>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/program_options.hpp>
+#include <cpptoml.h>
+#include <opencv2/core.hpp>
+
+#include "../../lib/shmemdf/Semaphore.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/ProgramOptions.h"
+
+#include "Pipeline.h"
+
+namespace po = boost::program_options;
+
+volatile sig_atomic_t quit = 0;
+
+const char usage_io[] =
+    "PIPELINE:\n"
+    "  Path to a TOML file containing a [[stage]] entry for each\n"
+    "  component. Each entry specifies the component, its type,\n"
+    "  source and sink, and optionally the key of a table in the same\n"
+    "  file holding the component's configuration, e.g.\n\n"
+    "    [[stage]]\n"
+    "    component = \"framefilt\"\n"
+    "    type = \"bsub\"\n"
+    "    source = \"raw\"\n"
+    "    sink = \"filt\"\n"
+    "    config = \"bsub\"\n\n"
+    "  Available components are frameserve, framefilt, posidet,\n"
+    "  posifilt and posisock.";
+
+const char purpose[] =
+    "Run all components of the pipeline described in PIPELINE. By default "
+    "each component runs on its own thread within this process.";
+
+void printUsage(const po::options_description &options)
+{
+    std::cout <<
+    "Usage: run [INFO]\n"
+    "   or: run PIPELINE [CONFIGURATION]\n";
+
+    std::cout << purpose << "\n";
+    std::cout << options << "\n";
+    std::cout << usage_io << std::endl;
+}
+
+// Signal handler to ensure shared resources are cleaned on exit due to ctrl-c
+void sigHandler(int)
+{
+    quit = 1;
+}
+
+int main(int argc, char *argv[])
+{
+    std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
+
+    std::string file;
+    const std::string comp_name = "run";
+
+    // Program options
+    po::options_description visible_options;
+
+    try {
+
+        po::options_description positional_opt_desc("POSITIONAL");
+        positional_opt_desc.add_options()
+            ("pipeline", po::value<std::string>(&file),
+             "Pipeline TOML file.")
+            ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("pipeline", 1);
+
+        po::options_description config_opts("CONFIGURATION");
+        config_opts.add_options()
+            ("processes,p",
+             "Run each component as a separate process instead of as a "
+             "thread within this one. This is equivalent to starting each "
+             "component by hand.")
+            ("dry-run,n",
+             "Print the command that would start each component as a "
+             "separate process and exit.")
+            ;
+
+        visible_options.add(oat::config::ComponentInfo::instance()->get())
+                       .add(config_opts);
+
+        po::options_description options;
+        options.add(positional_opt_desc).add(visible_options);
+
+        po::variables_map option_map;
+        po::store(po::command_line_parser(argc, argv)
+                  .options(options)
+                  .positional(positional_options)
+                  .run(),
+                  option_map);
+        po::notify(option_map);
+
+        // Check INFO arguments
+        if (option_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (option_map.count("version")) {
+            std::cout << oat::config::VERSION_STRING;
+            return 0;
+        }
+
+        if (!option_map.count("pipeline")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A PIPELINE must be specified.\n");
+            return -1;
+        }
+
+        oat::Pipeline pipeline(file);
+
+        if (option_map.count("dry-run")) {
+            for (const auto &s : pipeline.stages()) {
+                for (const auto &a : pipeline.commandLine(s))
+                    std::cout << a << " ";
+                std::cout << "\n";
+            }
+            return 0;
+        }
+
+        // Tell user
+        std::cout << oat::whoMessage(comp_name,
+                     "Running " + std::to_string(pipeline.stages().size())
+                     + " components from " + file + ".\n")
+                  << oat::whoMessage(comp_name, "Press CTRL+C to exit.\n");
+
+        bool ok = option_map.count("processes") ? pipeline.runProcesses()
+                                                : pipeline.runThreads(quit);
+
+        // Tell user
+        std::cout << oat::whoMessage(comp_name, "Exiting.") << std::endl;
+
+        return ok ? 0 : -1;
+
+    } catch (const po::error &ex) {
+        printUsage(visible_options);
+        std::cerr << oat::whoError(comp_name, ex.what()) << std::endl;
+    } catch (const cpptoml::parse_exception &ex) {
+        std::cerr << oat::whoError(comp_name, ex.what()) << std::endl;
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::whoError(comp_name, ex.what()) << std::endl;
+    } catch (const cv::Exception &ex) {
+        std::cerr << oat::whoError(comp_name, ex.what()) << std::endl;
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+        std::cerr << oat::whoError(comp_name, ex.what()) << std::endl;
+    } catch (...) {
+        std::cerr << oat::whoError(comp_name, "Unknown exception.")
+                  << std::endl;
+    }
+
+    // exit failure
+    return -1;
+}
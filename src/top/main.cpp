@@ -0,0 +1,407 @@
+//******************************************************************************
+//* File:   oat top main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/program_options.hpp>
+
+#include "../../lib/shmemdf/Node.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace po = boost::program_options;
+namespace bip = boost::interprocess;
+namespace bfs = boost::filesystem;
+
+// A SINK blocked for more than this fraction of the time is being held up by
+// its SOURCES
+constexpr double BACKPRESSURE_THRESHOLD {0.05};
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: top [INFO]\n"
+              << "   or: top [NAMES] [CONFIGURATION]\n"
+              << "Show live performance of the nodes specified by NAMES. If "
+                 "no NAMES are given, all nodes in shared memory are shown.\n\n"
+              << options << "\n";
+}
+
+// Counter values at a single point in time
+struct Snapshot {
+
+    struct End {
+        int32_t pid {0};
+        uint64_t posts {0};
+        uint64_t wait_ns {0};
+        uint64_t max_wait_ns {0};
+        uint64_t max_post_interval_ns {0};
+    };
+
+    uint64_t time {0};
+    oat::NodeState state {oat::NodeState::UNDEFINED};
+    size_t depth {0};
+    End sink;
+    std::map<size_t, End> sources; // By slot index
+};
+
+Snapshot::End readEnd(const oat::Counters &c)
+{
+    Snapshot::End e;
+    e.pid = c.pid.load(std::memory_order_relaxed);
+    e.posts = c.posts.load(std::memory_order_relaxed);
+    e.wait_ns = c.wait_ns.load(std::memory_order_relaxed);
+    e.max_wait_ns = c.max_wait_ns.load(std::memory_order_relaxed);
+    e.max_post_interval_ns
+        = c.max_post_interval_ns.load(std::memory_order_relaxed);
+    return e;
+}
+
+// A node mapped read-only so that monitoring cannot disturb it
+class NodeMonitor {
+public:
+
+    explicit NodeMonitor(const std::string &address)
+    : shmem_(bip::open_read_only, (address + "_node").c_str())
+    {
+        // The segment's mutex cannot be taken through a read-only mapping
+        auto ptr = shmem_.find_no_lock<bip::offset_ptr<oat::Node>>(
+                typeid(oat::Node).name()).first;
+        if (ptr != nullptr)
+            node_ = ptr->get();
+    }
+
+    bool valid() const { return node_ != nullptr; }
+
+    Snapshot snapshot() const
+    {
+        Snapshot s;
+        s.time = oat::Counters::now();
+        s.state = node_->sink_state();
+        s.depth = node_->depth();
+        s.sink = readEnd(node_->sink_counters());
+        for (size_t i = 0; i < node_->num_slots(); i++) {
+            if (node_->slot_in_use(i))
+                s.sources[i] = readEnd(node_->source_counters(i));
+        }
+
+        return s;
+    }
+
+private:
+
+    oat::shmem_t shmem_;
+    const oat::Node *node_ {nullptr};
+};
+
+std::string command(const int32_t pid)
+{
+    if (pid == 0)
+        return "-";
+
+    std::ifstream f("/proc/" + std::to_string(pid) + "/comm");
+    std::string name;
+    if (!std::getline(f, name))
+        return "(exited)";
+
+    return name;
+}
+
+std::vector<std::string> findNodes(void)
+{
+    const std::string suffix = "_node";
+    std::vector<std::string> names;
+
+    boost::system::error_code ec;
+    for (bfs::directory_iterator it("/dev/shm", ec), end; !ec && it != end;
+         it.increment(ec)) {
+
+        const auto f = it->path().filename().string();
+        if (f.size() > suffix.size()
+            && f.compare(f.size() - suffix.size(), suffix.size(), suffix) == 0)
+            names.push_back(f.substr(0, f.size() - suffix.size()));
+    }
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+struct Row {
+    std::string node, end, cmd;
+    int32_t pid;
+    double rate_hz, blocked, max_wait_ms, max_gap_ms;
+};
+
+Row makeRow(const std::string &node,
+            const std::string &end,
+            const Snapshot::End &now,
+            const Snapshot::End &prev,
+            const double dt_ns)
+{
+    // A new component took over this end since the last snapshot
+    const bool same = now.pid == prev.pid && now.posts >= prev.posts;
+
+    Row r;
+    r.node = node;
+    r.end = end;
+    r.pid = now.pid;
+    r.cmd = command(now.pid);
+    r.rate_hz = same ? 1e9 * (now.posts - prev.posts) / dt_ns : 0.0;
+    r.blocked = same ? (now.wait_ns - prev.wait_ns) / dt_ns : 0.0;
+    r.max_wait_ms = now.max_wait_ns / 1e6;
+    r.max_gap_ms = now.max_post_interval_ns / 1e6;
+
+    return r;
+}
+
+void print(const std::vector<Row> &rows, const std::string &bottleneck)
+{
+    std::cout << std::left
+              << std::setw(16) << "NODE"
+              << std::setw(8) << "END"
+              << std::setw(8) << "PID"
+              << std::setw(18) << "COMMAND"
+              << std::right
+              << std::setw(10) << "RATE(Hz)"
+              << std::setw(10) << "BLOCKED%"
+              << std::setw(14) << "MAX WAIT(ms)"
+              << std::setw(13) << "MAX GAP(ms)"
+              << "\n";
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto &r : rows) {
+        std::cout << std::left
+                  << std::setw(16) << r.node
+                  << std::setw(8) << r.end
+                  << std::setw(8) << r.pid
+                  << std::setw(18) << r.cmd
+                  << std::right
+                  << std::setw(10) << r.rate_hz
+                  << std::setw(10) << 100.0 * r.blocked
+                  << std::setw(14) << r.max_wait_ms
+                  << std::setw(13) << r.max_gap_ms
+                  << "\n";
+    }
+
+    std::cout << "\n" << bottleneck << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    std::vector<std::string> names;
+    size_t interval_ms {1000};
+    size_t iterations {0};
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+            ("help", "Produce help message.")
+            ("version,v", "Print version information.")
+            ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+            ("interval,i", po::value<size_t>(),
+             "Update interval in milliseconds. Defaults to 1000.")
+            ("iterations,n", po::value<size_t>(),
+             "Number of updates to show before exiting. Defaults to 0, "
+             "which means run until interrupted.")
+            ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+            ("names", po::value< std::vector<std::string> >(),
+            "The names of the nodes to monitor.")
+            ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("names", -1);
+
+        po::options_description all_options("ALL");
+        all_options.add(options).add(config).add(hidden);
+
+        po::options_description visible_options("OPTIONS");
+        visible_options.add(options).add(config);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Top version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (variable_map.count("interval"))
+            interval_ms = std::max<size_t>(variable_map["interval"].as<size_t>(), 1);
+
+        if (variable_map.count("iterations"))
+            iterations = variable_map["iterations"].as<size_t>();
+
+        if (variable_map.count("names"))
+            names = variable_map["names"].as< std::vector<std::string> >();
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    std::map<std::string, std::unique_ptr<NodeMonitor>> monitors;
+    std::map<std::string, Snapshot> previous;
+
+    for (size_t n = 0; iterations == 0 || n <= iterations; n++) {
+
+        // Attach to new nodes and forget about removed ones
+        auto current = names.empty() ? findNodes() : names;
+        for (auto it = monitors.begin(); it != monitors.end(); ) {
+            if (std::find(current.begin(), current.end(), it->first) == current.end()) {
+                previous.erase(it->first);
+                it = monitors.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        for (const auto &name : current) {
+            if (monitors.count(name))
+                continue;
+
+            try {
+                std::unique_ptr<NodeMonitor> m(new NodeMonitor(name));
+                if (m->valid())
+                    monitors[name] = std::move(m);
+            } catch (const bip::interprocess_exception &) {
+                // Node was removed or is not readable
+            }
+        }
+
+        std::vector<Row> rows;
+
+        // Index into rows rather than a pointer, which later push_backs
+        // would invalidate
+        const size_t NONE = static_cast<size_t>(-1);
+        size_t bottleneck {NONE};
+        double worst_backpressure {0.0};
+
+        for (const auto &m : monitors) {
+
+            const auto now = m.second->snapshot();
+            auto prev_it = previous.find(m.first);
+
+            if (prev_it != previous.end()) {
+
+                const auto &prev = prev_it->second;
+                const double dt = std::max<double>(now.time - prev.time, 1.0);
+
+                rows.push_back(makeRow(m.first, "sink", now.sink, prev.sink, dt));
+                const double backpressure = rows.back().blocked;
+                const size_t first_source = rows.size();
+
+                for (const auto &s : now.sources) {
+                    auto p = prev.sources.find(s.first);
+                    rows.push_back(makeRow("",
+                                           "src " + std::to_string(s.first),
+                                           s.second,
+                                           p != prev.sources.end() ? p->second
+                                                                   : Snapshot::End(),
+                                           dt));
+                }
+
+                // The SOURCE that is least often waiting is the one holding
+                // up a SINK that is being back-pressured
+                if (backpressure > BACKPRESSURE_THRESHOLD
+                    && backpressure > worst_backpressure
+                    && rows.size() > first_source) {
+
+                    worst_backpressure = backpressure;
+                    bottleneck = std::min_element(
+                        rows.begin() + first_source, rows.end(),
+                        [](const Row &a, const Row &b) { return a.blocked < b.blocked; })
+                        - rows.begin();
+                }
+            }
+
+            previous[m.first] = now;
+        }
+
+        if (n > 0) {
+
+            std::string summary = "No backpressure.";
+            if (bottleneck != NONE) {
+
+                // Find the node the bottleneck row belongs to
+                std::string node;
+                for (size_t i = 0; i <= bottleneck; i++)
+                    if (!rows[i].node.empty())
+                        node = rows[i].node;
+
+                const Row &b = rows[bottleneck];
+
+                std::ostringstream ss;
+                ss << std::fixed << std::setprecision(1)
+                   << "Bottleneck: " << b.cmd
+                   << " (pid " << b.pid << ", " << b.end << ")"
+                   << " reading '" << node << "'."
+                   << " Its sink is blocked "
+                   << 100.0 * worst_backpressure << "% of the time.";
+                summary = ss.str();
+            }
+
+            // Clear the terminal, like top
+            std::cout << "\033[2J\033[H";
+            print(rows, summary);
+        }
+
+        if (iterations == 0 || n < iterations)
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+
+    // Exit
+    return 0;
+}
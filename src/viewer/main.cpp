@@ -32,6 +32,7 @@
 #include <boost/interprocess/exceptions.hpp>
 #include <opencv2/core.hpp>
 
+#include "../../lib/shmemdf/Semaphore.h"
 #include "../../lib/utility/in_place.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/ProgramOptions.h"
@@ -113,6 +114,7 @@ void run(const std::shared_ptr<oat::ViewerBase> viewer)
 int main(int argc, char *argv[])
 {
     std::signal(SIGINT, sigHandler);
+    oat::Semaphore::setQuitFlag(&quit);
 
     std::string type;
     std::string source;
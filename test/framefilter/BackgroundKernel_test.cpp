@@ -0,0 +1,269 @@
+//******************************************************************************
+//* File:   BackgroundKernel_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../src/framefilter/BackgroundKernel.h"
+
+using oat::kernel::KernelPath;
+
+const std::vector<std::pair<KernelPath, std::string>> vector_paths {
+    {KernelPath::SSE, "SSE"}, {KernelPath::AVX2, "AVX2"}
+};
+
+// Row lengths around each vector width, so that every kernel has a scalar
+// tail of every length
+const std::vector<int> widths {
+    1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 1027
+};
+
+const std::vector<double> alphas { 1.0, 0.5, 0.1, 0.01 };
+
+int32_t fixedAlpha(const double alpha)
+{
+    return static_cast<int32_t>(std::lround(alpha * (1 << oat::kernel::ALPHA_FRAC_BITS)));
+}
+
+cv::Mat randomFrame(const int cols)
+{
+    cv::Mat m(1, cols, CV_8UC1);
+    cv::randu(m, 0, 256);
+    return m;
+}
+
+// 8.8 fixed-point background of an 8-bit one
+cv::Mat fixedBackground(const cv::Mat &background)
+{
+    cv::Mat q;
+    background.convertTo(q, CV_16U, 1 << oat::kernel::BACKGROUND_FRAC_BITS);
+    return q;
+}
+
+bool same(const cv::Mat &a, const cv::Mat &b)
+{
+    return cv::countNonZero(a != b) == 0;
+}
+
+SCENARIO ("Each vector subtraction kernel matches the scalar kernel.",
+          "[BackgroundKernel]") {
+
+    for (const auto &p : vector_paths) {
+
+        if (!oat::kernel::supported(p.first)) {
+            WARN ("The " + p.second + " kernels cannot run on this CPU.");
+            continue;
+        }
+
+        for (const int w : widths) {
+
+            GIVEN ("The " + p.second + " kernels and rows of "
+                   + std::to_string(w) + " samples") {
+
+                cv::theRNG().state = w;
+                const cv::Mat background = randomFrame(w);
+
+                WHEN ("A static background is subtracted") {
+
+                    const cv::Mat frame = randomFrame(w);
+                    cv::Mat expected(1, w, CV_8UC1), out(1, w, CV_8UC1);
+
+                    oat::kernel::subtract(KernelPath::SCALAR, frame.ptr(),
+                                          background.ptr(), expected.ptr(), w);
+                    oat::kernel::subtract(p.first, frame.ptr(),
+                                          background.ptr(), out.ptr(), w);
+
+                    THEN ("The results are identical") {
+                        REQUIRE (same(out, expected));
+                    }
+                }
+
+                WHEN ("An adaptive background follows a series of frames, "
+                      "in place") {
+
+                    for (const double alpha : alphas) {
+
+                        cv::Mat expected_bg = fixedBackground(background);
+                        cv::Mat bg = expected_bg.clone();
+                        bool identical = true;
+
+                        for (int i = 0; i < 20; i++) {
+
+                            const cv::Mat frame = randomFrame(w);
+                            cv::Mat expected(1, w, CV_8UC1);
+                            cv::Mat out = frame.clone();
+
+                            oat::kernel::subtractAdapt(KernelPath::SCALAR,
+                                                       frame.ptr(),
+                                                       expected_bg.ptr<uint16_t>(),
+                                                       expected.ptr(),
+                                                       w,
+                                                       fixedAlpha(alpha));
+                            oat::kernel::subtractAdapt(p.first,
+                                                       out.ptr(),
+                                                       bg.ptr<uint16_t>(),
+                                                       out.ptr(),
+                                                       w,
+                                                       fixedAlpha(alpha));
+
+                            identical = identical && same(out, expected)
+                                        && same(bg, expected_bg);
+                        }
+
+                        THEN ("The outputs and backgrounds are identical for "
+                              "alpha = " + std::to_string(alpha)) {
+                            REQUIRE (identical);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO ("The scalar subtraction kernels match the OpenCV implementation "
+          "they replaced.", "[BackgroundKernel]") {
+
+    GIVEN ("A random background") {
+
+        const int w = 4099;
+        cv::theRNG().state = 1;
+        const cv::Mat background = randomFrame(w);
+
+        WHEN ("A static background is subtracted") {
+
+            const cv::Mat frame = randomFrame(w);
+            cv::Mat out(1, w, CV_8UC1), expected;
+
+            oat::kernel::subtract(KernelPath::SCALAR, frame.ptr(),
+                                  background.ptr(), out.ptr(), w);
+            cv::subtract(frame, background, expected);
+
+            THEN ("The result matches cv::subtract exactly") {
+                REQUIRE (same(out, expected));
+            }
+        }
+
+        for (const double alpha : alphas) {
+
+            WHEN ("An adaptive background with alpha = "
+                  + std::to_string(alpha) + " follows a series of frames") {
+
+                cv::Mat bg_q = fixedBackground(background);
+                cv::Mat bg_f;
+                background.convertTo(bg_f, CV_32F);
+
+                double worst = 0;
+                for (int i = 0; i < 100; i++) {
+
+                    // Alternate between new scenes and small changes, which
+                    // the fixed-point model follows least closely
+                    cv::Mat frame = randomFrame(w);
+                    if (i % 2) {
+                        cv::Mat noise(1, w, CV_16SC1);
+                        cv::randu(noise, -3, 4);
+                        cv::Mat near;
+                        cv::add(background, noise, near, cv::noArray(), CV_16S);
+                        near.convertTo(frame, CV_8U);
+                    }
+
+                    cv::Mat out(1, w, CV_8UC1);
+                    oat::kernel::subtractAdapt(KernelPath::SCALAR,
+                                               frame.ptr(),
+                                               bg_q.ptr<uint16_t>(),
+                                               out.ptr(),
+                                               w,
+                                               fixedAlpha(alpha));
+
+                    // What the filter did before the kernels
+                    cv::Mat bg_8, expected;
+                    cv::accumulateWeighted(frame, bg_f, alpha);
+                    bg_f.convertTo(bg_8, CV_8U);
+                    cv::subtract(frame, bg_8, expected);
+
+                    worst = std::max(worst, cv::norm(out, expected, cv::NORM_INF));
+                }
+
+                THEN ("Every output is within one intensity level of "
+                      "accumulateWeighted, convertTo and subtract") {
+                    REQUIRE (worst <= 1);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO ("Adaptation with alpha = 1.0 does not overflow.",
+          "[BackgroundKernel]") {
+
+    GIVEN ("Frames and backgrounds at opposite extremes") {
+
+        // Largest positive and negative differences, (255 << 8) - 0 and
+        // 0 - 0xFFFF, times 1 << 15 are within an int32_t only just
+        const int w = 67;
+        const uint8_t levels[] = {0, 255};
+        const uint16_t bgs[] = {0, 255 << 8, 0xFFFF};
+
+        std::vector<std::pair<KernelPath, std::string>> paths {
+            {KernelPath::SCALAR, "scalar"}
+        };
+        for (const auto &p : vector_paths)
+            if (oat::kernel::supported(p.first))
+                paths.push_back(p);
+
+        for (const auto &p : paths) {
+            for (const uint8_t f : levels) {
+                for (const uint16_t b : bgs) {
+
+                    WHEN ("The " + p.second + " kernel sees frame level "
+                          + std::to_string(f) + " on background "
+                          + std::to_string(b)) {
+
+                        cv::Mat frame(1, w, CV_8UC1, cv::Scalar(f));
+                        cv::Mat bg(1, w, CV_16UC1, cv::Scalar(b));
+                        cv::Mat out(1, w, CV_8UC1);
+
+                        oat::kernel::subtractAdapt(p.first,
+                                                   frame.ptr(),
+                                                   bg.ptr<uint16_t>(),
+                                                   out.ptr(),
+                                                   w,
+                                                   fixedAlpha(1.0));
+
+                        THEN ("The background becomes the frame and "
+                              "nothing is left after subtraction") {
+                            REQUIRE (cv::countNonZero(
+                                bg != (static_cast<int>(f) << oat::kernel::BACKGROUND_FRAC_BITS)) == 0);
+                            REQUIRE (cv::countNonZero(out) == 0);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,123 @@
+//******************************************************************************
+//* File:   ThresholdKernel_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/version.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../src/framefilter/ThresholdKernel.h"
+
+// Passbands whose edges are tested. Includes empty, single level and out of
+// range bands.
+const std::vector<std::pair<int, int>> bands {
+    {0, 255}, {50, 200}, {100, 100}, {0, 0}, {255, 255}, {1, 254},
+    {-5, 300}, {200, 50}, {256, 300}, {-10, -1}
+};
+
+// What the filter did before the kernels: cvtColor, inRange, masked copy
+cv::Mat reference(const cv::Mat &in, const int lo, const int hi)
+{
+    cv::Mat grey, mask, out;
+    if (in.channels() == 3)
+        cv::cvtColor(in, grey, cv::COLOR_BGR2GRAY);
+    else
+        grey = in;
+
+    cv::inRange(grey, lo, hi, mask);
+    in.copyTo(out);
+    out.setTo(cv::Scalar::all(0), mask == 0);
+
+    return out;
+}
+
+bool same(const cv::Mat &a, const cv::Mat &b)
+{
+    return cv::countNonZero(a.reshape(1) != b.reshape(1)) == 0;
+}
+
+SCENARIO ("The BGR threshold kernel matches cvtColor and inRange.",
+          "[ThresholdKernel]") {
+
+    GIVEN ("A frame holding every 24-bit colour") {
+
+        // An odd width leaves a remainder for the scalar tail
+        cv::Mat in(4094, 4099, CV_8UC3);
+        uint8_t *p = in.ptr();
+        for (size_t i = 0; i < in.total(); i++) {
+            p[3 * i] = i & 0xFF;
+            p[3 * i + 1] = (i >> 8) & 0xFF;
+            p[3 * i + 2] = (i >> 16) & 0xFF;
+        }
+
+        for (const auto &b : bands) {
+
+            WHEN ("The passband is [" + std::to_string(b.first) + ", "
+                  + std::to_string(b.second) + "]") {
+
+                cv::Mat out(in.size(), in.type());
+                oat::kernel::thresholdBGR(in.ptr(), out.ptr(), in.total(),
+                                          b.first, b.second);
+
+#if CV_VERSION_MAJOR == 3
+                THEN ("Every pixel is kept or zeroed as cvtColor and inRange "
+                      "would") {
+                    REQUIRE (same(out, reference(in, b.first, b.second)));
+                }
+#else
+                THEN ("Exact agreement is only expected with OpenCV 3") {
+                    WARN ("Built against OpenCV " CV_VERSION ", whose BGR to "
+                          "grey weights differ from the kernel's.");
+                }
+#endif
+            }
+        }
+    }
+}
+
+SCENARIO ("The grey threshold kernel matches inRange.", "[ThresholdKernel]") {
+
+    GIVEN ("A frame holding every grey level") {
+
+        cv::Mat in(1, 256 * 17 + 5, CV_8UC1);
+        for (int i = 0; i < in.cols; i++)
+            in.at<uint8_t>(0, i) = i & 0xFF;
+
+        for (const auto &b : bands) {
+
+            WHEN ("The passband is [" + std::to_string(b.first) + ", "
+                  + std::to_string(b.second) + "]") {
+
+                cv::Mat out(in.size(), in.type());
+                oat::kernel::thresholdGrey(in.ptr(), out.ptr(), in.total(),
+                                           b.first, b.second);
+
+                THEN ("Every pixel is kept or zeroed as inRange would") {
+                    REQUIRE (same(out, reference(in, b.first, b.second)));
+                }
+            }
+        }
+    }
+}
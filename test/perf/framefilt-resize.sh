@@ -0,0 +1,8 @@
+# Downsampling cost vs. frame size
+for f in earth-1MP.jpg beach-5MP.jpg; do
+    echo $f
+    oat framefilt resize raw flt -c test.toml framefilt-resize &
+    sleep 1
+    time oat frameserve test raw -f $f -c test.toml test
+    wait
+done
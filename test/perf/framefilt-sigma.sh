@@ -0,0 +1,8 @@
+# Sigma-delta segmentation cost vs. frame size
+for f in earth-1MP.jpg beach-5MP.jpg; do
+    echo $f
+    oat framefilt sigma raw flt -c test.toml framefilt-sigma &
+    sleep 1
+    time oat frameserve test raw -f $f -c test.toml test
+    wait
+done
@@ -0,0 +1,9 @@
+# Thresholding cost vs. frame size. BGR frames are converted to luma and
+# range tested in a single pass.
+for f in earth-1MP.jpg beach-5MP.jpg; do
+    echo $f
+    oat framefilt thresh raw flt -c test.toml framefilt-thresh &
+    sleep 1
+    time oat frameserve test raw -f $f -c test.toml test
+    wait
+done
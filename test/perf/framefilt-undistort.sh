@@ -1,3 +1,8 @@
-oat framefilt undistort raw flt -c test.toml framefilt-undistort &
-sleep 1
-time oat frameserve test raw -f $1 -c test.toml test
+# Undistortion cost vs. frame size
+for f in earth-1MP.jpg beach-5MP.jpg; do
+    echo $f
+    oat framefilt undistort raw flt -c test.toml framefilt-undistort &
+    sleep 1
+    time oat frameserve test raw -f $f -c test.toml test
+    wait
+done
@@ -0,0 +1,186 @@
+//******************************************************************************
+//* File:   Arena_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include "../../lib/shmemdf/Arena.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+const std::string node_addr = "test";
+
+struct Point {
+    int x, y;
+};
+
+using Contour = oat::ArenaVector<Point>;
+using Contours = oat::ArenaVector<Contour>;
+
+// A token with both fixed and variable size members
+struct Blobs {
+
+    explicit Blobs(oat::ArenaAllocator &arena)
+    : areas(arena)
+    {
+        // Nothing
+    }
+
+    uint64_t frame {0};
+    oat::ArenaVector<double> areas;
+};
+
+SCENARIO ("ArenaVectors allocate from a fixed block of memory.", "[Arena]") {
+
+    GIVEN ("An arena with 1 kB of storage") {
+
+        alignas(oat::ArenaAllocator::ALIGNMENT) char storage[1024];
+        oat::ArenaAllocator arena(storage, sizeof(storage));
+
+        WHEN ("Elements are added to a vector") {
+
+            Contour c(arena);
+            for (int i = 0; i < 20; i++)
+                c.push_back({i, -i});
+
+            THEN ("The elements are stored in the arena") {
+                REQUIRE (c.size() == 20);
+                REQUIRE (c[19].x == 19);
+                REQUIRE (c[19].y == -19);
+                REQUIRE (reinterpret_cast<char *>(c.data()) >= storage);
+                REQUIRE (reinterpret_cast<char *>(c.data() + c.size())
+                         <= storage + sizeof(storage));
+                REQUIRE (arena.used() > 0);
+            }
+        }
+
+        WHEN ("Vectors are nested") {
+
+            Contours cs(arena);
+            for (int i = 0; i < 3; i++) {
+                auto &c = cs.emplace_back();
+                for (int j = 0; j <= i; j++)
+                    c.push_back({i, j});
+            }
+
+            THEN ("Inner vectors allocate from the same arena") {
+                REQUIRE (cs.size() == 3);
+                REQUIRE (cs[2].size() == 3);
+                REQUIRE (cs[2][2].y == 2);
+                REQUIRE (&cs[1].arena() == &arena);
+            }
+        }
+
+        WHEN ("More is allocated than the arena holds") {
+
+            Contour c(arena);
+
+            THEN ("The allocation throws") {
+                REQUIRE_THROWS( c.reserve(1000); );
+            }
+        }
+
+        WHEN ("The arena is cleared") {
+
+            Contour c(arena);
+            c.reserve(100);
+            arena.clear();
+
+            THEN ("All of its storage is available again") {
+                REQUIRE (arena.available() == sizeof(storage));
+            }
+        }
+    }
+}
+
+SCENARIO ("Variable size tokens can be passed through a node.", "[Arena]") {
+
+    GIVEN ("A sink and source of contours with common node address") {
+
+        oat::Source<oat::Arena<Contours>> source;
+        oat::Sink<oat::Arena<Contours>> sink;
+
+        source.touch(node_addr);
+        sink.bind(node_addr, 64 * 1024);
+        source.connect();
+
+        WHEN ("The sink writes a different number of contours each time") {
+
+            THEN ("The source reads them in place") {
+
+                for (int n = 1; n <= 5; n++) {
+
+                    sink.wait();
+                    Contours *cs = sink.retrieve();
+                    REQUIRE (cs->empty());
+                    for (int i = 0; i < n; i++) {
+                        std::vector<Point> pts(10 * n, Point{n, i});
+                        cs->emplace_back().assign(pts.begin(), pts.end());
+                    }
+                    sink.post();
+
+                    REQUIRE (source.wait() == oat::NodeState::SINK_BOUND);
+                    const Contours *read = source.retrieve();
+                    REQUIRE (read->size() == static_cast<size_t>(n));
+                    for (const auto &c : *read) {
+                        REQUIRE (c.size() == static_cast<size_t>(10 * n));
+                        REQUIRE (c[0].x == n);
+                    }
+                    source.post();
+                }
+            }
+        }
+    }
+
+    GIVEN ("A sink and source of a struct token with a ring depth of 2") {
+
+        oat::Source<oat::Arena<Blobs>> source;
+        oat::Sink<oat::Arena<Blobs>> sink;
+
+        source.touch(node_addr);
+        sink.bind(node_addr, 4096, 2);
+        source.connect();
+
+        WHEN ("The sink writes twice before the source reads") {
+
+            for (int n = 1; n <= 2; n++) {
+                sink.wait();
+                Blobs *b = sink.retrieve();
+                b->frame = n;
+                for (int i = 0; i < n; i++)
+                    b->areas.push_back(n * 10.0 + i);
+                sink.post();
+            }
+
+            THEN ("Each sample keeps its own arena") {
+                for (int n = 1; n <= 2; n++) {
+                    REQUIRE (source.wait() == oat::NodeState::SINK_BOUND);
+                    const Blobs *b = source.retrieve();
+                    REQUIRE (b->frame == static_cast<uint64_t>(n));
+                    REQUIRE (b->areas.size() == static_cast<size_t>(n));
+                    REQUIRE (b->areas[n - 1] == n * 10.0 + n - 1);
+                    source.post();
+                }
+            }
+        }
+    }
+}
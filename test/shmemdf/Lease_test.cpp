@@ -0,0 +1,134 @@
+//******************************************************************************
+//* File:   Lease_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <string>
+#include <utility>
+
+#include "../../lib/shmemdf/Lease.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+const std::string node_addr = "test";
+
+// Counts calls to post()
+struct Endpoint {
+    void post() { posts++; }
+    int posts {0};
+};
+
+SCENARIO ("Leases post to their endpoint exactly once.", "[Lease]") {
+
+    GIVEN ("An endpoint") {
+
+        Endpoint e;
+
+        WHEN ("A lease goes out of scope") {
+
+            {
+                oat::Lease<Endpoint, int> lease(&e, 1);
+                REQUIRE (static_cast<bool>(lease));
+                REQUIRE (*lease == 1);
+            }
+
+            THEN ("The endpoint is posted once") {
+                REQUIRE (e.posts == 1);
+            }
+        }
+
+        WHEN ("A lease is released and then goes out of scope") {
+
+            {
+                oat::Lease<Endpoint, int> lease(&e, 1);
+                lease.release();
+                REQUIRE (!lease);
+            }
+
+            THEN ("The endpoint is posted once") {
+                REQUIRE (e.posts == 1);
+            }
+        }
+
+        WHEN ("A lease is moved") {
+
+            {
+                oat::Lease<Endpoint, int> a(&e, 1);
+                oat::Lease<Endpoint, int> b(std::move(a));
+                REQUIRE (!a);
+                REQUIRE (*b == 1);
+            }
+
+            THEN ("The endpoint is posted once") {
+                REQUIRE (e.posts == 1);
+            }
+        }
+
+        WHEN ("A default constructed lease goes out of scope") {
+
+            {
+                oat::Lease<Endpoint, int> lease;
+                REQUIRE (!lease);
+            }
+
+            THEN ("The endpoint is not posted") {
+                REQUIRE (e.posts == 0);
+            }
+        }
+    }
+}
+
+SCENARIO ("Releasing a lease replaces post().", "[Lease]") {
+
+    GIVEN ("A bound sink and connected source") {
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+
+        oat::Source<int> source;
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink writes under a lease") {
+
+            {
+                sink.wait();
+                oat::Lease<oat::SinkBase<int>, int *> lease(&sink, sink.retrieve());
+                **lease = 42;
+            }
+
+            THEN ("The source can read the value under a lease") {
+                source.wait();
+                oat::Lease<oat::SourceBase<int>, const int *>
+                    lease(&source, source.retrieve());
+                REQUIRE (**lease == 42);
+            }
+
+            AND_THEN ("The sink can write again once the source releases") {
+                source.wait();
+                oat::Lease<oat::SourceBase<int>, const int *>
+                    lease(&source, source.retrieve());
+                REQUIRE (source.write_number() == 1);
+                lease.release();
+                REQUIRE_NOTHROW( sink.wait(); );
+            }
+        }
+    }
+}
@@ -0,0 +1,168 @@
+//******************************************************************************
+//* File:   LocalNode_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <boost/interprocess/exceptions.hpp>
+
+#include "../../lib/shmemdf/LocalNode.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+const std::string frame_addr = "local_frames";
+const std::string int_addr = "local_ints";
+const std::string block_addr = "local_block";
+const std::string shared_addr = "local_shared";
+
+SCENARIO ("Local nodes pass frames between threads without a copy.",
+          "[LocalNode]") {
+
+    GIVEN ("A reserved address with a frame SINK and SOURCE") {
+
+        oat::LocalNode::reserve(frame_addr);
+
+        oat::Sink<oat::Frame> sink;
+        sink.bind(frame_addr, 12, 2);
+        auto frame = sink.retrieve(2, 2, CV_8UC3, oat::PIX_BGR);
+
+        oat::Source<oat::Frame> source;
+        source.touch(frame_addr);
+        source.connect(oat::PIX_BGR);
+
+        THEN ("Nothing is placed in /dev/shm") {
+            REQUIRE (access(("/dev/shm/" + frame_addr + "_node").c_str(), F_OK) != 0);
+            REQUIRE (access(("/dev/shm/" + frame_addr + "_obj").c_str(), F_OK) != 0);
+        }
+
+        THEN ("The SOURCE sees the SINK's frame format") {
+            REQUIRE (source.parameters().rows == 2);
+            REQUIRE (source.parameters().cols == 2);
+            REQUIRE (source.parameters().bytes == 12);
+        }
+
+        WHEN ("The SINK writes a frame") {
+
+            sink.wait();
+            frame = sink.retrieve();
+            frame.data[0] = 42;
+            frame.incrementSampleCount();
+            sink.post();
+
+            THEN ("The SOURCE reads the SINK's matrix in place") {
+                auto lease = source.acquire();
+                REQUIRE (static_cast<bool>(lease));
+                REQUIRE (lease->data == frame.data);
+                REQUIRE (lease->data[0] == 42);
+                REQUIRE (lease->sample_count() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO ("Local nodes hold generic tokens.", "[LocalNode]") {
+
+    GIVEN ("A reserved address with an int SINK and SOURCE") {
+
+        oat::LocalNode::reserve(int_addr);
+
+        std::unique_ptr<oat::Sink<int>> sink(new oat::Sink<int>());
+        sink->bind(int_addr, oat::RingDepth(2), 0);
+
+        oat::Source<int> source;
+        source.touch(int_addr);
+        source.connect();
+
+        WHEN ("The SINK writes and then leaves") {
+
+            sink->wait();
+            *sink->retrieve() = 7;
+            sink->post();
+
+            REQUIRE (source.wait() == oat::NodeState::SINK_BOUND);
+            REQUIRE (*source.retrieve() == 7);
+            source.post();
+
+            sink.reset();
+
+            THEN ("The SOURCE sees the END state") {
+                REQUIRE (source.wait() == oat::NodeState::END);
+            }
+        }
+    }
+}
+
+SCENARIO ("Cancelling wakes SINKS and SOURCES blocked in wait().",
+          "[LocalNode]") {
+
+    GIVEN ("A SINK blocked on a local SOURCE that does not read and a SOURCE "
+           "blocked on a shared SINK that does not write") {
+
+        oat::LocalNode::reserve(block_addr);
+
+        oat::Sink<int> sink;
+        sink.bind(block_addr, 0);
+        oat::Source<int> source;
+        source.touch(block_addr);
+        source.connect();
+
+        // The SOURCE is admitted by this write and never reads it
+        sink.wait();
+        sink.post();
+
+        bool interrupted = false;
+        std::thread blocked_sink([&sink, &interrupted] {
+            try {
+                sink.wait();
+            } catch (const boost::interprocess::interprocess_exception &ex) {
+                interrupted = ex.get_error_code() == 1;
+            }
+        });
+
+        oat::Sink<int> shared_sink;
+        shared_sink.bind(shared_addr, 0);
+        oat::Source<int> shared_source;
+        shared_source.touch(shared_addr);
+        shared_source.connect();
+
+        oat::NodeState state = oat::NodeState::UNDEFINED;
+        std::thread blocked_source([&shared_source, &state] {
+            state = shared_source.wait();
+        });
+
+        WHEN ("All waits are cancelled") {
+
+            oat::LocalNode::cancelAll();
+            blocked_sink.join();
+            blocked_source.join();
+
+            // Cancelling cannot be undone, so this is checked only once
+            THEN ("The SINK unwinds as if interrupted and the SOURCE sees "
+                  "the END state") {
+                REQUIRE (interrupted);
+                REQUIRE (state == oat::NodeState::END);
+            }
+        }
+    }
+}
@@ -20,24 +20,80 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <cstdlib>
+#include <memory>
+#include <new>
+
 #include "../../lib/shmemdf/Node.h"
 
-SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
+// Slots are cache aligned, which new[] does not guarantee before C++17, so
+// they are placed in memory from posix_memalign
+struct SlotDeleter {
+
+    void operator()(oat::Node::Slot *slots) const
+    {
+        for (size_t i = 0; i < num_slots; i++)
+            slots[i].~Slot();
+        std::free(slots);
+    }
+
+    size_t num_slots;
+};
+
+using slots_ptr_t = std::unique_ptr<oat::Node::Slot[], SlotDeleter>;
+
+slots_ptr_t makeSlots(const size_t num_slots)
+{
+    void *mem {nullptr};
+    if (posix_memalign(&mem, alignof(oat::Node::Slot),
+                       num_slots * sizeof(oat::Node::Slot)))
+        throw std::bad_alloc();
+
+    auto slots = static_cast<oat::Node::Slot *>(mem);
+    for (size_t i = 0; i < num_slots; i++)
+        new (slots + i) oat::Node::Slot();
+
+    return slots_ptr_t(slots, SlotDeleter{num_slots});
+}
+
+// Node whose SOURCE slots live on the heap rather than in shared memory
+struct HeapNode {
+
+    explicit HeapNode(const size_t num_slots)
+    : slots(makeSlots(num_slots))
+    , node(slots.get(), num_slots)
+    {
+        // Nothing
+    }
+
+    slots_ptr_t slots;
+    oat::Node node;
+};
+
+SCENARIO ("Nodes can accept up to Node::num_slots() sources.", "[Node]") {
 
     GIVEN ("A fresh Node") {
 
-        oat::Node node;
+        HeapNode heap_node(oat::Node::DEFAULT_SLOTS);
+        oat::Node &node = heap_node.node;
+        REQUIRE (node.num_slots() == size_t{oat::Node::DEFAULT_SLOTS});
         REQUIRE (node.source_ref_count() == 0);
         REQUIRE (node.sink_state() == oat::NodeState::UNDEFINED);
 
-        WHEN ("Node::NUM_SLOTS+1 sources are added") {
+        WHEN ("Node::num_slots()+1 sources are added") {
 
-            THEN ("The Node shall return normal exit codes until the 11th") {
-                for (size_t i = 0; i <= oat::Node::NUM_SLOTS; i++) {
-                    if (i < oat::Node::NUM_SLOTS)
-                        REQUIRE (node.acquireSlot(i) == 0);
-                    else
-                        REQUIRE (node.acquireSlot(i) < 0);
+            THEN ("The Node shall return normal exit codes until the last") {
+                for (size_t i = 0; i <= node.num_slots(); i++) {
+                    size_t idx;
+                    if (i < node.num_slots()) {
+                        REQUIRE (node.acquireSlot(idx) == 0);
+                        REQUIRE (idx == i);
+                        REQUIRE_NOTHROW(
+                            oat::Node::semaphore &s = node.read_barrier(idx);
+                        );
+                    } else {
+                        REQUIRE (node.acquireSlot(idx) < 0);
+                    }
                 }
             }
         }
@@ -55,7 +111,7 @@ SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
 
             THEN ("The Node shall throw") {
                 REQUIRE_THROWS(
-                    boost::interprocess::interprocess_semaphore &s = node.read_barrier(-1);
+                    oat::Node::semaphore &s = node.read_barrier(-1);
                 );
             }
         }
@@ -67,9 +123,87 @@ SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
 
             THEN ("reading a greater indexed read-barrier shall throw") {
                 REQUIRE_THROWS(
-                boost::interprocess::interprocess_semaphore &s = node.read_barrier(idx+1);
+                oat::Node::semaphore &s = node.read_barrier(idx+1);
                 );
             }
         }
     }
 }
+
+SCENARIO ("Nodes with more slots than fit in one mask word track reads.", "[Node]") {
+
+    GIVEN ("A Node with 200 slots, all bound") {
+
+        const size_t num_slots = 200;
+        HeapNode heap_node(num_slots);
+        oat::Node &node = heap_node.node;
+
+        for (size_t i = 0; i < num_slots; i++) {
+            size_t idx;
+            REQUIRE (node.acquireSlot(idx) == 0);
+        }
+        REQUIRE (node.source_ref_count() == num_slots);
+
+        WHEN ("The sink writes") {
+
+            node.write_barrier.wait();
+            node.notifySinkWriteComplete();
+
+            THEN ("Only the last source to read reports it") {
+                for (size_t i = 0; i < num_slots; i++) {
+                    REQUIRE (node.read_barrier(i).try_wait());
+                    REQUIRE (node.notifySourceReadComplete(i)
+                             == (i == num_slots - 1));
+                }
+            }
+
+            AND_THEN ("Departing sources give up their reads") {
+                for (size_t i = 0; i < num_slots - 1; i++)
+                    node.notifySourceReadComplete(i);
+                REQUIRE (node.write_barrier.try_wait() == false);
+                REQUIRE (node.releaseSlot(num_slots - 1) == 0);
+                REQUIRE (node.write_barrier.try_wait());
+                REQUIRE (node.source_ref_count() == num_slots - 1);
+            }
+        }
+    }
+}
+
+SCENARIO ("Nodes keep performance counters for the sink and each source.", "[Node]") {
+
+    GIVEN ("A fresh Node with a single source") {
+
+        HeapNode heap_node(oat::Node::DEFAULT_SLOTS);
+        oat::Node &node = heap_node.node;
+
+        size_t idx;
+        REQUIRE (node.acquireSlot(idx) == 0);
+        REQUIRE (node.slot_in_use(idx));
+        REQUIRE (node.source_counters(idx).posts == 0);
+
+        WHEN ("The sink and source wait and post") {
+
+            for (int i = 0; i < 3; i++) {
+                node.sink_counters().recordWait(oat::Counters::now());
+                node.sink_counters().recordPost();
+                node.source_counters(idx).recordPost();
+            }
+
+            THEN ("The counters reflect each end's activity") {
+                REQUIRE (node.sink_counters().waits == 3);
+                REQUIRE (node.sink_counters().posts == 3);
+                REQUIRE (node.source_counters(idx).posts == 3);
+                REQUIRE (node.source_counters(idx).waits == 0);
+                REQUIRE (node.sink_counters().max_post_interval_ns
+                         <= node.sink_counters().post_interval_ns);
+            }
+
+            AND_THEN ("A new source in the same slot starts from zero") {
+                REQUIRE (node.releaseSlot(idx) == 0);
+                REQUIRE (node.slot_in_use(idx) == false);
+                REQUIRE (node.acquireSlot(idx) == 0);
+                REQUIRE (node.source_counters(idx).posts == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,167 @@
+//******************************************************************************
+//* File:   Semaphore_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <chrono>
+#include <csignal>
+#include <future>
+#include <thread>
+
+#include <pthread.h>
+
+#include "../../lib/shmemdf/Semaphore.h"
+
+using msec = std::chrono::milliseconds;
+
+volatile sig_atomic_t quit = 0;
+void quitHandler(int) { quit = 1; }
+void otherHandler(int) { }
+
+SCENARIO ("Semaphores count posts and block waiters when the count is 0.",
+          "[Semaphore]") {
+
+    GIVEN ("A semaphore with an initial count of 2") {
+
+        oat::Semaphore sem(2);
+
+        WHEN ("the semaphore is waited on twice") {
+
+            REQUIRE(sem.wait());
+            REQUIRE(sem.wait());
+
+            THEN ("try_wait() shall fail") {
+                REQUIRE_FALSE(sem.try_wait());
+            }
+
+            THEN ("a third wait() shall block until the semaphore is posted") {
+
+                auto fut = std::async(std::launch::async, [&sem]{ return sem.wait(); });
+
+                // Pause for 5 ms
+                std::this_thread::sleep_for(msec(5));
+
+                // Check to see that the waiter is still blocked
+                auto status = fut.wait_for(msec(0));
+                REQUIRE(status != std::future_status::ready);
+
+                sem.post();
+
+                // Give sufficient time for wait to release
+                status = fut.wait_for(msec(50));
+                REQUIRE(status == std::future_status::ready);
+                REQUIRE(fut.get());
+            }
+        }
+    }
+}
+
+SCENARIO ("Closing a semaphore wakes all of its waiters.", "[Semaphore]") {
+
+    GIVEN ("A semaphore with an initial count of 0 and two waiters") {
+
+        oat::Semaphore sem(0);
+
+        auto f0 = std::async(std::launch::async, [&sem]{ return sem.wait(); });
+        auto f1 = std::async(std::launch::async, [&sem]{ return sem.wait(); });
+
+        WHEN ("the semaphore is closed") {
+
+            // Make sure both waiters have gone to sleep
+            std::this_thread::sleep_for(msec(5));
+            REQUIRE(f0.wait_for(msec(0)) != std::future_status::ready);
+            REQUIRE(f1.wait_for(msec(0)) != std::future_status::ready);
+
+            sem.close();
+
+            THEN ("both waiters shall be released without acquiring") {
+
+                REQUIRE(f0.wait_for(msec(50)) == std::future_status::ready);
+                REQUIRE(f1.wait_for(msec(50)) == std::future_status::ready);
+                REQUIRE_FALSE(f0.get());
+                REQUIRE_FALSE(f1.get());
+            }
+
+            THEN ("further waits shall not block") {
+                REQUIRE(f0.wait_for(msec(50)) == std::future_status::ready);
+                REQUIRE_FALSE(sem.wait());
+            }
+        }
+    }
+}
+
+SCENARIO ("Only the quit signal interrupts a wait.", "[Semaphore]") {
+
+    GIVEN ("A semaphore with an initial count of 0, a waiter, and a "
+           "registered quit flag") {
+
+        // Install without SA_RESTART so that the futex wait sees EINTR
+        struct sigaction sa {};
+        sa.sa_handler = otherHandler;
+        sigaction(SIGUSR1, &sa, nullptr);
+        sa.sa_handler = quitHandler;
+        sigaction(SIGINT, &sa, nullptr);
+
+        quit = 0;
+        oat::Semaphore::setQuitFlag(&quit);
+
+        oat::Semaphore sem(0);
+        int error_code = 0;
+        bool acquired = false;
+        std::thread waiter([&] {
+            try {
+                acquired = sem.wait();
+            } catch (const boost::interprocess::interprocess_exception &ex) {
+                error_code = ex.get_error_code();
+            }
+        });
+
+        std::this_thread::sleep_for(msec(5));
+
+        WHEN ("the waiter receives some other signal") {
+
+            for (int i = 0; i < 5; i++) {
+                pthread_kill(waiter.native_handle(), SIGUSR1);
+                std::this_thread::sleep_for(msec(5));
+            }
+
+            sem.post();
+            waiter.join();
+
+            THEN ("it shall keep waiting until the semaphore is posted") {
+                REQUIRE(acquired);
+                REQUIRE(error_code == 0);
+            }
+        }
+
+        WHEN ("the waiter receives SIGINT") {
+
+            pthread_kill(waiter.native_handle(), SIGINT);
+            waiter.join();
+
+            THEN ("wait() shall throw with error code 1") {
+                REQUIRE_FALSE(acquired);
+                REQUIRE(error_code == 1);
+            }
+        }
+
+        oat::Semaphore::setQuitFlag(nullptr);
+    }
+}
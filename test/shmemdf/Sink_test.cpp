@@ -21,10 +21,13 @@
 #include <catch.hpp>
 
 #include <string>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "../../lib/datatypes/Color.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 #include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
 
 const std::string node_addr = "test";
 
@@ -182,3 +185,47 @@ SCENARIO ("Sink<SharedFrameHeader> must bind() before waiting, posting, or alloc
         }
     }
 }
+
+SCENARIO ("Sinks reclaim the slots of sources that die.", "[Sink]") {
+
+    GIVEN ("A bound Sink<int> and a source in another process") {
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+
+        const pid_t pid = fork();
+        if (pid == 0) {
+            oat::Source<int> source;
+            source.touch(node_addr);
+            source.connect();
+
+            // Die without releasing the slot
+            _exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+
+        WHEN ("The source dies holding a slot") {
+
+            THEN ("The sink keeps writing and a new source can read") {
+
+                for (int i = 0; i < 3; i++) {
+                    sink.wait();
+                    *sink.retrieve() = i;
+                    sink.post();
+                }
+
+                oat::Source<int> source;
+                source.touch(node_addr);
+                source.connect();
+
+                sink.wait();
+                *sink.retrieve() = 42;
+                sink.post();
+
+                REQUIRE (source.wait() == oat::NodeState::SINK_BOUND);
+                REQUIRE (*source.retrieve() == 42);
+                source.post();
+            }
+        }
+    }
+}
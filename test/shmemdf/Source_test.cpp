@@ -20,7 +20,11 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <memory>
 #include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
@@ -28,75 +32,72 @@
 
 const std::string node_addr = "test";
 
-SCENARIO ("Up to 10 sources can connect a single Node.", "[Source]") {
+SCENARIO ("Up to Node::DEFAULT_SLOTS sources can connect a single Node.", "[Source]") {
 
-    GIVEN ("11 sources and a bound sink with common node address") {
+    GIVEN ("Node::DEFAULT_SLOTS+1 sources and a bound sink with common node address") {
 
         oat::Sink<int> sink;
 
         INFO ("The sink binds a node");
         sink.bind(node_addr);
-        oat::Source<int> s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10;
+        oat::Source<int> sources[oat::Node::DEFAULT_SLOTS + 1];
 
-        WHEN ("sources 0 to Oat::Node:NUM_SLOTS connect a node") {
+        WHEN ("sources 0 to Oat::Node:DEFAULT_SLOTS connect a node") {
 
-            THEN ("The first 10 connections will succeed") {
+            THEN ("The first Node::DEFAULT_SLOTS connections will succeed") {
                 REQUIRE_NOTHROW(
-                    s0.touch(node_addr);
-                    s1.touch(node_addr);
-                    s2.touch(node_addr);
-                    s3.touch(node_addr);
-                    s4.touch(node_addr);
-                    s5.touch(node_addr);
-                    s6.touch(node_addr);
-                    s7.touch(node_addr);
-                    s8.touch(node_addr);
-                    s9.touch(node_addr);
-
-                    s0.connect();
-                    s1.connect();
-                    s2.connect();
-                    s3.connect();
-                    s4.connect();
-                    s5.connect();
-                    s6.connect();
-                    s7.connect();
-                    s8.connect();
-                    s9.connect();
+                    for (size_t i = 0; i < oat::Node::DEFAULT_SLOTS; i++) {
+                        sources[i].touch(node_addr);
+                        sources[i].connect();
+                    }
                 );
             }
 
-            AND_THEN ("The oat::Node:NUM_SLOTS+1 connection shall throw") {
+            AND_THEN ("The oat::Node:DEFAULT_SLOTS+1 connection shall throw") {
                 REQUIRE_THROWS(
-                    s0.touch(node_addr);
-                    s1.touch(node_addr);
-                    s2.touch(node_addr);
-                    s3.touch(node_addr);
-                    s4.touch(node_addr);
-                    s5.touch(node_addr);
-                    s6.touch(node_addr);
-                    s7.touch(node_addr);
-                    s8.touch(node_addr);
-                    s9.touch(node_addr);
-                    s10.touch(node_addr);
-
-                    s0.connect();
-                    s1.connect();
-                    s2.connect();
-                    s3.connect();
-                    s4.connect();
-                    s5.connect();
-                    s6.connect();
-                    s7.connect();
-                    s8.connect();
-                    s9.connect();
-                    s10.connect();
+                    for (auto &s : sources) {
+                        s.touch(node_addr);
+                        s.connect();
+                    }
                 );
             }
         }
     }
 }
 
+SCENARIO ("A sink can set the maximum number of sources before binding.", "[Source]") {
+
+    GIVEN ("A sink that allows 100 sources") {
+
+        oat::Sink<int> sink;
+        sink.set_max_sources(100);
+        sink.bind(node_addr);
+
+        WHEN ("100 sources connect") {
+
+            std::vector<std::unique_ptr<oat::Source<int>>> sources;
+            for (size_t i = 0; i < 100; i++)
+                sources.emplace_back(new oat::Source<int>());
+
+            THEN ("All connections will succeed") {
+                REQUIRE_NOTHROW(
+                    for (auto &s : sources) {
+                        s->touch(node_addr);
+                        s->connect();
+                    }
+                );
+            }
+        }
+
+        WHEN ("The sink tries to set the maximum after binding") {
+
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.set_max_sources(200); );
+            }
+        }
+    }
+}
+
 SCENARIO ("Sources must connect() before waiting or posting.", "[Source]") {
 
     GIVEN ("A single, unconnected source ") {
@@ -213,3 +214,114 @@ SCENARIO ("Connected sources can retrieve shared objects to mutate them.", "[Sou
 
 
 // TODO: specialization tests
+
+SCENARIO ("Sources end when their sink dies.", "[Source]") {
+
+    GIVEN ("A source and a sink in another process with common node address") {
+
+        oat::Source<int> source;
+        source.touch(node_addr);
+
+        const pid_t pid = fork();
+        if (pid == 0) {
+            oat::Sink<int> sink;
+            sink.bind(node_addr);
+
+            // Die without unbinding
+            _exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+
+        WHEN ("The sink dies after binding the node") {
+
+            source.connect();
+
+            THEN ("The source's wait() returns END") {
+                REQUIRE (source.wait() == oat::NodeState::END);
+            }
+
+            THEN ("A new sink can bind the address and serve new sources") {
+
+                oat::Sink<int> sink;
+                REQUIRE_NOTHROW( sink.bind(node_addr); );
+
+                oat::Source<int> restarted;
+                restarted.touch(node_addr);
+                restarted.connect();
+
+                sink.wait();
+                *sink.retrieve() = 42;
+                sink.post();
+
+                REQUIRE (restarted.wait() == oat::NodeState::SINK_BOUND);
+                REQUIRE (*restarted.retrieve() == 42);
+                restarted.post();
+            }
+        }
+    }
+}
+
+SCENARIO ("Reconnectable sources wait for a new sink to resume the stream.", "[Source]") {
+
+    GIVEN ("A reconnectable source and a reconnectable sink that leaves") {
+
+        oat::Source<int> source;
+        source.set_reconnectable(true);
+        source.touch(node_addr);
+
+        {
+            oat::Sink<int> sink;
+            sink.set_reconnectable(true);
+            sink.bind(node_addr);
+            source.connect();
+
+            sink.wait();
+            *sink.retrieve() = 1;
+            sink.post();
+        }
+
+        REQUIRE (source.wait() == oat::NodeState::SINK_BOUND);
+        REQUIRE (*source.retrieve() == 1);
+        source.post();
+
+        WHEN ("A new sink binds the address") {
+
+            oat::Sink<int> sink;
+            sink.bind(node_addr);
+
+            THEN ("It resumes the stream") {
+
+                REQUIRE (sink.resumed());
+
+                sink.wait();
+                *sink.retrieve() = 2;
+                sink.post();
+
+                REQUIRE (source.wait() == oat::NodeState::SINK_BOUND);
+                REQUIRE (*source.retrieve() == 2);
+                source.post();
+            }
+        }
+
+        WHEN ("A new sink with a different ring depth binds the address") {
+
+            oat::Sink<int> sink;
+
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.bind(node_addr, oat::RingDepth(2)); );
+            }
+        }
+
+        WHEN ("A source that is not reconnectable waits on the stream") {
+
+            oat::Source<int> other;
+            other.set_reconnectable(false);
+            other.touch(node_addr);
+            other.connect();
+
+            THEN ("Its wait() returns END") {
+                REQUIRE (other.wait() == oat::NodeState::END);
+            }
+        }
+    }
+}
@@ -69,6 +69,17 @@
 //            3. A source connects
 //            4. The source attempts to enter the critical section
 //        - Then, the source shall block until the sink enters/exits the critical section
+//- Given a sink and a source
+//    - When, 1. The sink binds
+//            2. The source connects and attempts to enter the critical section
+//            3. The sink is destructed
+//        - Then, the source shall be released immediately with the END state
+//
+//### A Sink bound with ring depth N may write N samples ahead of its slowest Source
+//- Given a sink bound with a ring depth of 3 and a source
+//    - When the sink writes 3 samples that the source has not read
+//        - Then, the sink shall block on its fourth write until the source reads
+//        - Then, the source shall read the samples in the order they were written
 
 using msec = std::chrono::milliseconds;
 const std::string node_addr = "test";
@@ -522,3 +533,100 @@ SCENARIO ("Sources attaching or detaching during source or sink wait() periods "
         }
     }
 }
+
+SCENARIO ("A Sink leaving a Node releases all waiting Sources at once.",
+          "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink and a source.") {
+
+        auto sink = new oat::Sink<int>();
+        oat::Source<int> source;
+
+        WHEN ("1. The sink binds, "
+              "2. The source connects and attempts to enter the critical section, "
+              "3. The sink is destructed") {
+
+            sink->bind(node_addr);
+            source.touch(node_addr);
+            source.connect();
+            auto fut = std::async(std::launch::async, [&source]{ return source.wait(); });
+
+            // Pause for 5 ms
+            std::this_thread::sleep_for(msec(5));
+            REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+            delete sink;
+
+            THEN ("The source shall be released immediately with the END state") {
+
+                REQUIRE(fut.wait_for(msec(5)) == std::future_status::ready);
+                REQUIRE(fut.get() == oat::NodeState::END);
+            }
+        }
+    }
+}
+
+SCENARIO ("A Sink bound with ring depth N may write N samples ahead of its "
+          "slowest Source.", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink bound with a ring depth of 3 and a source") {
+
+        const size_t depth = 3;
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        sink.bind(node_addr, oat::RingDepth(depth), 0);
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink writes 3 samples that the source has not read") {
+
+            for (size_t i = 0; i < depth; i++) {
+
+                auto fut = std::async(std::launch::async, [&sink, i] {
+                    sink.wait();
+                    *sink.retrieve() = i;
+                    sink.post();
+                });
+
+                // None of these writes should block
+                REQUIRE(fut.wait_for(msec(5)) == std::future_status::ready);
+            }
+
+            THEN ("The sink shall block on its fourth write until the "
+                  "source reads") {
+
+                auto fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+
+                // Pause for 5 ms
+                std::this_thread::sleep_for(msec(5));
+
+                // Check to see that the sink has not stopped waiting
+                auto status = fut.wait_for(msec(0));
+                REQUIRE(status != std::future_status::ready);
+
+                // The source reads the oldest sample, freeing its slot
+                REQUIRE_NOTHROW(source.wait());
+                REQUIRE_NOTHROW(source.post());
+
+                // Give sufficient time for wait to release
+                std::this_thread::sleep_for(msec(1));
+                status = fut.wait_for(msec(0));
+                REQUIRE(status == std::future_status::ready);
+
+                REQUIRE_NOTHROW(sink.post());
+            }
+
+            THEN ("The source shall read the samples in the order they "
+                  "were written") {
+
+                for (size_t i = 0; i < depth; i++) {
+                    REQUIRE_NOTHROW(source.wait());
+                    REQUIRE(source.clone() == static_cast<int>(i));
+                    REQUIRE_NOTHROW(source.post());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,96 @@
+//******************************************************************************
+//* File:   fanout_bench.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Fan-out benchmark: one sink, many sources, all exchanging a small token
+// through a common node. Measures the cost of node synchronization itself.
+//
+// Usage: fanout_bench [NUM_SOURCES] [NUM_WRITES]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+const std::string node_addr = "fanout_bench";
+
+int main(int argc, char *argv[]) {
+
+    const size_t num_sources = argc > 1 ? std::stoul(argv[1]) : 8;
+    const uint64_t num_writes = argc > 2 ? std::stoull(argv[2]) : 100000;
+
+    oat::Sink<uint64_t> sink;
+    if (num_sources > oat::Node::DEFAULT_SLOTS)
+        sink.set_max_sources(num_sources);
+    sink.bind(node_addr);
+
+    std::atomic<size_t> num_connected {0};
+    std::vector<std::thread> sources;
+
+    for (size_t i = 0; i < num_sources; i++) {
+        sources.emplace_back([&num_connected, num_writes] {
+
+            oat::Source<uint64_t> source;
+            source.touch(node_addr);
+            source.connect();
+            ++num_connected;
+
+            uint64_t sum = 0;
+            for (uint64_t n = 0; n < num_writes; n++) {
+                if (source.wait() == oat::NodeState::END)
+                    break;
+                sum += *source.retrieve();
+                source.post();
+            }
+
+            if (sum != num_writes * (num_writes - 1) / 2)
+                std::cerr << "Source read incorrect values.\n";
+        });
+    }
+
+    while (num_connected < num_sources)
+        std::this_thread::yield();
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t n = 0; n < num_writes; n++) {
+        sink.wait();
+        *sink.retrieve() = n;
+        sink.post();
+    }
+
+    for (auto &s : sources)
+        s.join();
+
+    std::chrono::duration<double> elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Sources: " << num_sources
+              << ", writes: " << num_writes
+              << ", writes/s: " << num_writes / elapsed.count()
+              << ", ns/write: " << 1e9 * elapsed.count() / num_writes
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,373 @@
+//******************************************************************************
+//* File:   ipc_bench.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Cross-process IPC benchmark: one sink in this process and 1 to 10 sources,
+// each in its own child process, exchanging frames (VGA to 5 MP) or
+// positions through a common node. Sources either copy each sample out of
+// shared memory or read it in place.
+//
+// Hop latency is the time from the sink stamping a sample's capture time,
+// just before it writes it, to a source having the sample in hand. Results
+// are printed to stdout as JSON so that they can be compared between builds.
+// Use a Release build: debug builds log each write to stdout as well.
+//
+// Usage: ipc_bench [NUM_SAMPLES] [MAX_SOURCES] > results.json
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+using Clock = std::chrono::steady_clock;
+
+const std::string node_addr = "ipc_bench";
+
+// Samples at the start of each run that are not counted toward latency
+static constexpr size_t WARMUP {10};
+
+enum class Transfer { COPY, RETRIEVE };
+
+const char *transferName(const Transfer t)
+{
+    return t == Transfer::COPY ? "copy" : "retrieve";
+}
+
+struct Config {
+    int rows, cols; // Frame size. Unused for positions.
+    size_t sources;
+    Transfer transfer;
+    size_t samples;
+};
+
+struct Result {
+    double samples_per_s;
+    std::vector<uint64_t> latency_ns; // All sources, sorted
+};
+
+/* Token specific sink and source ends */
+
+template <typename T>
+struct Token;
+
+template <>
+struct Token<oat::Frame> {
+
+    static constexpr const char *name {"frame"};
+
+    explicit Token(const Config &c)
+    : src(c.rows, c.cols, CV_8UC3)
+    {
+        sink.bind(node_addr, src.total() * src.elemSize());
+        frame = sink.retrieve(c.rows, c.cols, CV_8UC3, oat::PIX_BGR);
+    }
+
+    void write(const Config &c, const uint64_t n)
+    {
+        sink.wait();
+        frame.set_capture_ns();
+        if (c.transfer == Transfer::COPY)
+            src.copyTo(frame);
+        else
+            frame.data[0] = static_cast<uchar>(n);
+        sink.post();
+    }
+
+    // Returns the sample's capture time once it is in hand
+    static uint64_t read(const Config &c,
+                         oat::Source<oat::Frame> &source,
+                         oat::Frame &local)
+    {
+        if (c.transfer == Transfer::COPY) {
+            source.copyTo(local);
+            return local.sample().capture_ns();
+        }
+
+        const oat::Frame *f = source.retrieve();
+        volatile uchar first = f->data[0];
+        (void)first;
+        return f->sample().capture_ns();
+    }
+
+    using Local = oat::Frame;
+
+    oat::Sink<oat::Frame> sink;
+    oat::Frame frame;
+    cv::Mat src;
+};
+
+template <>
+struct Token<oat::Position2D> {
+
+    static constexpr const char *name {"position"};
+
+    explicit Token(const Config &)
+    {
+        sink.bind(node_addr, node_addr);
+        position = sink.retrieve();
+    }
+
+    void write(const Config &c, const uint64_t n)
+    {
+        sink.wait();
+        if (c.transfer == Transfer::COPY) {
+            src.set_capture_ns();
+            src.position.x = n;
+            *position = src;
+        } else {
+            position->set_capture_ns();
+            position->position.x = n;
+        }
+        sink.post();
+    }
+
+    static uint64_t read(const Config &c,
+                         oat::Source<oat::Position2D> &source,
+                         oat::Position2D &local)
+    {
+        if (c.transfer == Transfer::COPY) {
+            local = source.clone();
+            return local.sample().capture_ns();
+        }
+
+        return source.retrieve()->sample().capture_ns();
+    }
+
+    struct Local : oat::Position2D { Local() : oat::Position2D("") { } };
+
+    oat::Sink<oat::Position2D> sink;
+    oat::Position2D *position {nullptr};
+    oat::Position2D src {"src"};
+};
+
+/* Process plumbing */
+
+void writeAll(const int fd, const void *buf, size_t bytes)
+{
+    auto p = static_cast<const char *>(buf);
+    while (bytes > 0) {
+        const ssize_t n = ::write(fd, p, bytes);
+        if (n <= 0)
+            throw std::runtime_error("Pipe write failed.");
+        p += n;
+        bytes -= n;
+    }
+}
+
+void readAll(const int fd, void *buf, size_t bytes)
+{
+    auto p = static_cast<char *>(buf);
+    while (bytes > 0) {
+        const ssize_t n = ::read(fd, p, bytes);
+        if (n <= 0)
+            throw std::runtime_error("Pipe read failed.");
+        p += n;
+        bytes -= n;
+    }
+}
+
+// Body of a source child process. Signals when it has connected, reads
+// every sample and then sends back its latencies.
+template <typename T>
+void runSource(const Config &c, const int ready_fd, const int result_fd)
+{
+    std::vector<uint64_t> latency;
+    latency.reserve(c.samples);
+
+    {
+        oat::Source<T> source;
+        source.touch(node_addr);
+        source.connect();
+
+        const char ok = 1;
+        writeAll(ready_fd, &ok, 1);
+
+        typename Token<T>::Local local;
+        for (size_t n = 0; n < c.samples; n++) {
+
+            if (source.wait() == oat::NodeState::END)
+                break;
+
+            const uint64_t captured = Token<T>::read(c, source, local);
+            latency.push_back(oat::Sample::monotonicNs() - captured);
+
+            source.post();
+        }
+    }
+
+    const uint64_t count = latency.size();
+    writeAll(result_fd, &count, sizeof(count));
+    writeAll(result_fd, latency.data(), count * sizeof(uint64_t));
+}
+
+template <typename T>
+Result run(const Config &c)
+{
+    Result r;
+    std::vector<pid_t> pids;
+    std::vector<int> ready_fds, result_fds;
+
+    Token<T> token(c);
+
+    for (size_t i = 0; i < c.sources; i++) {
+
+        int ready[2], result[2];
+        if (pipe(ready) != 0 || pipe(result) != 0)
+            throw std::runtime_error("Could not create pipes.");
+
+        const pid_t pid = fork();
+        if (pid == 0) {
+            close(ready[0]);
+            close(result[0]);
+            int rc = 0;
+            try {
+                runSource<T>(c, ready[1], result[1]);
+            } catch (const std::exception &ex) {
+                std::cerr << "Source failed: " << ex.what() << "\n";
+                rc = 1;
+            }
+
+            // Skip the destructors of the parent's sink
+            _exit(rc);
+        }
+
+        close(ready[1]);
+        close(result[1]);
+        pids.push_back(pid);
+        ready_fds.push_back(ready[0]);
+        result_fds.push_back(result[0]);
+    }
+
+    for (auto fd : ready_fds) {
+        char ok;
+        readAll(fd, &ok, 1);
+        close(fd);
+    }
+
+    auto start = Clock::now();
+    for (uint64_t n = 0; n < c.samples; n++)
+        token.write(c, n);
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    r.samples_per_s = c.samples / elapsed.count();
+
+    for (auto fd : result_fds) {
+        uint64_t count;
+        readAll(fd, &count, sizeof(count));
+        std::vector<uint64_t> latency(count);
+        readAll(fd, latency.data(), count * sizeof(uint64_t));
+        close(fd);
+
+        if (count > WARMUP)
+            r.latency_ns.insert(r.latency_ns.end(),
+                                latency.begin() + WARMUP, latency.end());
+    }
+
+    // Sources must be gone before the sink is, so that the node is removed
+    // and can be bound again by the next run
+    for (auto pid : pids)
+        waitpid(pid, nullptr, 0);
+
+    std::sort(r.latency_ns.begin(), r.latency_ns.end());
+
+    return r;
+}
+
+/* Reporting */
+
+uint64_t percentile(const std::vector<uint64_t> &sorted, const double p)
+{
+    if (sorted.empty())
+        return 0;
+
+    const size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+void printResult(const char *token,
+                 const Config &c,
+                 const Result &r,
+                 const bool first)
+{
+    const auto &l = r.latency_ns;
+
+    std::cout << (first ? "\n" : ",\n")
+              << "    {\"token\": \"" << token << "\""
+              << ", \"rows\": " << c.rows
+              << ", \"cols\": " << c.cols
+              << ", \"sources\": " << c.sources
+              << ", \"transfer\": \"" << transferName(c.transfer) << "\""
+              << ", \"samples_per_s\": " << r.samples_per_s
+              << ", \"latency_ns\": {"
+              << "\"p50\": " << percentile(l, 0.5)
+              << ", \"p99\": " << percentile(l, 0.99)
+              << ", \"p999\": " << percentile(l, 0.999)
+              << ", \"max\": " << (l.empty() ? 0 : l.back())
+              << ", \"count\": " << l.size()
+              << "}}";
+}
+
+int main(int argc, char *argv[]) {
+
+    const size_t num_samples = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const size_t max_sources = argc > 2 ? std::stoul(argv[2]) : 10;
+
+    struct Size { int rows, cols; };
+    const Size sizes[] = { {480, 640}, {1024, 1024}, {1944, 2592} };
+    const size_t source_counts[] = {1, 2, 5, 10};
+    const Transfer transfers[] = {Transfer::COPY, Transfer::RETRIEVE};
+
+    std::cout << "{\n  \"benchmark\": \"ipc_bench\""
+              << ",\n  \"samples\": " << num_samples
+              << ",\n  \"results\": [";
+
+    bool first = true;
+    for (const auto n : source_counts) {
+
+        if (n > max_sources)
+            continue;
+
+        for (const auto t : transfers) {
+
+            for (const auto &s : sizes) {
+                Config c {s.rows, s.cols, n, t, num_samples};
+                printResult(Token<oat::Frame>::name, c,
+                            run<oat::Frame>(c), first);
+                first = false;
+            }
+
+            Config c {0, 0, n, t, num_samples};
+            printResult(Token<oat::Position2D>::name, c,
+                        run<oat::Position2D>(c), first);
+        }
+    }
+
+    std::cout << "\n  ]\n}" << std::endl;
+
+    return 0;
+}
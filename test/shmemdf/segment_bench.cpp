@@ -0,0 +1,146 @@
+//******************************************************************************
+//* File:   segment_bench.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Shared frame segment benchmark: compares first frame latency and copy
+// throughput for 1 MP and 5 MP frames with each combination of segment
+// memory options.
+//
+// Usage: segment_bench [NUM_FRAMES]
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+using Clock = std::chrono::steady_clock;
+using msec = std::chrono::duration<double, std::milli>;
+
+const std::string node_addr = "segment_bench";
+
+struct Result {
+    double bind_ms; // Sink bind and frame allocation
+    double first_write_ms; // First frame written by the sink
+    double first_read_ms; // First frame read by a source
+    double gb_per_s; // Steady state write + read throughput
+    oat::SegmentOptions applied;
+};
+
+Result run(const int rows, const int cols,
+           const oat::SegmentOptions &options,
+           const size_t num_frames)
+{
+    Result r;
+    const size_t bytes = rows * cols * 3;
+    std::vector<char> in(bytes, 1), out(bytes);
+
+    auto t0 = Clock::now();
+
+    oat::Sink<oat::Frame> sink;
+    sink.bind(node_addr, bytes, 1, options);
+    oat::Frame frame = sink.retrieve(rows, cols, CV_8UC3, oat::PIX_BGR);
+    r.applied = sink.segment_options();
+
+    // Sources are admitted on the sink's next write
+    oat::Source<oat::Frame> source;
+    source.touch(node_addr);
+    source.connect();
+
+    auto t1 = Clock::now();
+
+    sink.wait();
+    std::memcpy(frame.data, in.data(), bytes);
+    sink.post();
+
+    auto t2 = Clock::now();
+
+    source.wait();
+    std::memcpy(out.data(), source.retrieve()->data, bytes);
+    source.post();
+
+    auto t3 = Clock::now();
+
+    for (size_t i = 0; i < num_frames; i++) {
+
+        sink.wait();
+        std::memcpy(frame.data, in.data(), bytes);
+        sink.post();
+
+        source.wait();
+        std::memcpy(out.data(), source.retrieve()->data, bytes);
+        source.post();
+    }
+
+    auto t4 = Clock::now();
+
+    r.bind_ms = msec(t1 - t0).count();
+    r.first_write_ms = msec(t2 - t1).count();
+    r.first_read_ms = msec(t3 - t2).count();
+    r.gb_per_s = 2.0 * bytes * num_frames
+                 / std::chrono::duration<double>(t4 - t3).count() / 1e9;
+
+    return r;
+}
+
+std::string describe(const oat::SegmentOptions &o)
+{
+    std::string s;
+    s += o.huge_pages ? "+huge" : "";
+    s += o.prefault ? "+prefault" : "";
+    s += o.lock ? "+mlock" : "";
+    return s.empty() ? "default" : s.substr(1);
+}
+
+int main(int argc, char *argv[]) {
+
+    const size_t num_frames = argc > 1 ? std::stoul(argv[1]) : 200;
+
+    struct Size { const char *name; int rows, cols; };
+    const Size sizes[] = { {"1 MP", 1024, 1024}, {"5 MP", 2048, 2560} };
+
+    std::vector<oat::SegmentOptions> configs(4);
+    configs[1].prefault = true;
+    configs[2].huge_pages = configs[2].prefault = true;
+    configs[3].huge_pages = configs[3].prefault = configs[3].lock = true;
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (const auto &size : sizes) {
+        for (const auto &c : configs) {
+
+            auto r = run(size.rows, size.cols, c, num_frames);
+
+            std::cout << size.name
+                      << ", requested: " << describe(c)
+                      << ", applied: " << describe(r.applied)
+                      << ", bind ms: " << r.bind_ms
+                      << ", first write ms: " << r.first_write_ms
+                      << ", first read ms: " << r.first_read_ms
+                      << ", GB/s: " << r.gb_per_s
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}